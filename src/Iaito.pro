@@ -313,6 +313,7 @@ QMAKE_SUBSTITUTES += IaitoConfig.h.in
 SOURCES += \
     Main.cpp \
     core/Iaito.cpp \
+    core/IaitoCoreLock.cpp \
     dialogs/EditStringDialog.cpp \
     dialogs/WriteCommandsDialogs.cpp \
     widgets/DisassemblerGraphView.cpp \
@@ -397,6 +398,21 @@ SOURCES += \
     widgets/BacktraceWidget.cpp \
     dialogs/MapFileDialog.cpp \
     common/CommandTask.cpp \
+    common/GraphLayoutTask.cpp \
+    common/MemoryPageCache.cpp \
+    common/InstructionIndex.cpp \
+    common/CommentCache.cpp \
+    common/DigestTask.cpp \
+    common/DensityIndex.cpp \
+    common/DisassemblyTokenizer.cpp \
+    common/DebugSnapshot.cpp \
+    common/Telescope.cpp \
+    common/ConsoleOutputReader.cpp \
+    common/StringsTask.cpp \
+    common/SearchTask.cpp \
+    common/DecompilerCache.cpp \
+    common/DecompilerPrefetcher.cpp \
+    common/DecompileExportTask.cpp \
     common/ProgressIndicator.cpp \
     common/R2Task.cpp \
     dialogs/R2TaskDialog.cpp \
@@ -471,6 +487,7 @@ GRAPHVIZ_SOURCES = \
 HEADERS  += \
     common/R2Shims.h \
     core/Iaito.h \
+    core/IaitoCoreLock.h \
     core/IaitoCommon.h \
     core/IaitoDescriptions.h \
     dialogs/EditStringDialog.h \
@@ -561,6 +578,20 @@ HEADERS  += \
     common/StringsTask.h \
     common/FunctionsTask.h \
     common/CommandTask.h \
+    common/GraphLayoutTask.h \
+    common/MemoryPageCache.h \
+    common/InstructionIndex.h \
+    common/CommentCache.h \
+    common/DigestTask.h \
+    common/DensityIndex.h \
+    common/DisassemblyTokenizer.h \
+    common/DebugSnapshot.h \
+    common/Telescope.h \
+    common/ConsoleOutputReader.h \
+    common/SearchTask.h \
+    common/DecompilerCache.h \
+    common/DecompilerPrefetcher.h \
+    common/DecompileExportTask.h \
     common/ProgressIndicator.h \
     plugins/IaitoPlugin.h \
     common/R2Task.h \
@@ -6,6 +6,7 @@
 #include "R2pdcCmdDecompiler.h"
 #include "R2retdecDecompiler.h"
 #include "common/CrashHandler.h"
+#include "common/DecompileExportTask.h"
 #include "common/Decompiler.h"
 #include "common/PythonManager.h"
 #include "common/ResourcePaths.h"
@@ -201,6 +202,9 @@ IaitoApplication::IaitoApplication(int &argc, char **argv)
     } else { // filename specified as positional argument
         bool askOptions = clOptions.analLevel != AutomaticAnalysisLevel::Ask;
         mainWindow->openNewFile(clOptions.fileOpenOptions, askOptions);
+        if (!clOptions.decompileDir.isEmpty()) {
+            decompileToDirectory(clOptions.decompileDir);
+        }
     }
 
 #if 0
@@ -272,6 +276,36 @@ void IaitoApplication::launchNewInstance(const QStringList &args)
     process.startDetached(qApp->applicationFilePath(), allArgs);
 }
 
+void IaitoApplication::decompileToDirectory(const QString &dir)
+{
+    Decompiler *decompiler = DecompileExportTask::exportDecompiler();
+    if (!decompiler) {
+        fprintf(
+            stderr,
+            "%s\n",
+            tr("None of the available decompilers can run in a separate radare2 process.")
+                .toLocal8Bit()
+                .constData());
+        // the event loop is not running yet
+        QMetaObject::invokeMethod(this, [] { QCoreApplication::exit(1); }, Qt::QueuedConnection);
+        return;
+    }
+    exportTask.reset(new DecompileExportTask(decompiler, {}, dir));
+    connect(exportTask.data(), &AsyncTask::logChanged, this, [](const QString &log) {
+        QString line = log.trimmed().section(QLatin1Char('\n'), -1);
+        if (!line.isEmpty()) {
+            fprintf(stderr, "%s\n", line.toLocal8Bit().constData());
+        }
+    });
+    connect(exportTask.data(), &AsyncTask::finished, this, [this]() {
+        // No functions means the file or its analysis failed, not success
+        bool ok = exportTask->getFunctionCount() && exportTask->getWrittenCount();
+        exportTask.clear();
+        QCoreApplication::exit(ok ? 0 : 1);
+    });
+    Core()->getAsyncTaskManager()->start(exportTask);
+}
+
 bool IaitoApplication::event(QEvent *e)
 {
     if (e->type() == QEvent::FileOpen) {
@@ -428,6 +462,13 @@ bool IaitoApplication::parseCommandLineOptions()
     QCommandLineOption disableR2Plugins("no-r2-plugins", QObject::tr("Do not load radare2 plugins"));
     cmd_parser.addOption(disableR2Plugins);
 
+    QCommandLineOption decompileOption(
+        "decompile-to",
+        QObject::tr("Decompile every function to a directory and quit. "
+                    "Needs filename and analysis level to be specified."),
+        QObject::tr("directory"));
+    cmd_parser.addOption(decompileOption);
+
     cmd_parser.process(*this);
 
     IaitoCommandLineOptions opts;
@@ -472,6 +513,19 @@ bool IaitoApplication::parseCommandLineOptions()
         return false;
     }
 
+    if (cmd_parser.isSet(decompileOption)) {
+        if (opts.analLevel == AutomaticAnalysisLevel::Ask) {
+            fprintf(
+                stderr,
+                "%s\n",
+                QObject::tr("Analysis level must be specified to decompile to a directory.")
+                    .toLocal8Bit()
+                    .constData());
+            return false;
+        }
+        opts.decompileDir = cmd_parser.value(decompileOption);
+    }
+
     InitialOptions options;
     if (!opts.args.isEmpty()) {
         opts.fileOpenOptions.filename = opts.args[0];
@@ -8,6 +8,8 @@
 
 #include "core/MainWindow.h"
 
+class DecompileExportTask;
+
 enum class AutomaticAnalysisLevel { Ask, None, AAA, AAAA, AAAAA };
 
 struct IaitoCommandLineOptions
@@ -19,6 +21,8 @@ struct IaitoCommandLineOptions
     bool outputRedirectionEnabled = true;
     bool enableIaitoPlugins = true;
     bool enableR2Plugins = true;
+    // decompile every function to that directory and quit once done
+    QString decompileDir;
 };
 
 class IaitoApplication : public QApplication
@@ -47,11 +51,17 @@ private:
      * @return false if options have error
      */
     bool parseCommandLineOptions();
+    /**
+     * @brief Decompile every function of the analyzed file to dir, print the
+     * progress to stderr and quit once done
+     */
+    void decompileToDirectory(const QString &dir);
 
 private:
     bool m_FileAlreadyDropped;
     MainWindow *mainWindow;
     IaitoCommandLineOptions clOptions;
+    QSharedPointer<DecompileExportTask> exportTask;
 };
 
 /**
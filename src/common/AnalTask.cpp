@@ -111,7 +111,8 @@ void AnalTask::runTask()
             }
             // log(cmd.description);
             log(cmd.command + " : " + cmd.description);
-            // use cmd instead of cmdRaw because commands can be unexpected
+            // use cmd instead of cmdRaw because commands can be unexpected.
+            // The core is locked per command, readers get in between them.
             Core()->cmd(cmd.command);
         }
         log(tr("Analysis complete!"));
@@ -7,6 +7,8 @@ AsyncTask::AsyncTask()
 {
     setAutoDelete(false);
     running = false;
+    // step() driven tasks are never started, so never go through prepareRun()
+    interrupted = false;
 }
 
 AsyncTask::~AsyncTask()
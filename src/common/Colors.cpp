@@ -14,7 +14,7 @@ void Colors::colorizeAssembly(RichTextPainter::List &list, QString opcode, ut64
     assembly.text = opcode;
 
     QString colorName = Colors::getColor(type_num);
-    assembly.textColor = ConfigColor(colorName);
+    assembly.textColor = Config()->getColor(colorName);
     list.push_back(assembly);
 }
 
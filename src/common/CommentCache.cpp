@@ -0,0 +1,44 @@
+#include "CommentCache.h"
+#include "core/Iaito.h"
+
+CommentCache::CommentCache(IaitoCore *core)
+    : QObject(core)
+{
+    connect(core, &IaitoCore::commentsChanged, this, &CommentCache::update);
+    connect(core, &IaitoCore::refreshAll, this, &CommentCache::invalidate);
+    connect(core, &IaitoCore::codeRebased, this, &CommentCache::invalidate);
+}
+
+QString CommentCache::at(RVA addr)
+{
+    QMutexLocker locker(&mutex);
+    if (!valid) {
+        comments.clear();
+        for (const CommentDescription &comment : Core()->getAllComments("CCu")) {
+            comments.insert(comment.offset, comment.name);
+        }
+        valid = true;
+    }
+    return comments.value(addr);
+}
+
+void CommentCache::invalidate()
+{
+    QMutexLocker locker(&mutex);
+    valid = false;
+    comments.clear();
+}
+
+void CommentCache::update(RVA addr)
+{
+    QMutexLocker locker(&mutex);
+    if (!valid) {
+        return;
+    }
+    QString comment = Core()->getCommentAt(addr);
+    if (comment.isEmpty()) {
+        comments.remove(addr);
+    } else {
+        comments.insert(addr, comment);
+    }
+}
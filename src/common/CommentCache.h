@@ -0,0 +1,45 @@
+#ifndef COMMENTCACHE_H
+#define COMMENTCACHE_H
+
+#include "core/IaitoCommon.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+
+class IaitoCore;
+
+/**
+ * @brief Snapshot of all the comments, keyed by address.
+ *
+ * Models showing a comment column read it from here, so rendering and
+ * sorting by comment doesn't query the core for every row or comparison.
+ * The snapshot is built on first use, single comments are updated on
+ * commentsChanged and everything is read again after a global refresh.
+ */
+class IAITO_EXPORT CommentCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CommentCache(IaitoCore *core);
+
+    /**
+     * @return comment at addr, or an empty string if there is none
+     */
+    QString at(RVA addr);
+
+    /**
+     * @brief Read all the comments again on next use
+     */
+    void invalidate();
+
+private:
+    QMutex mutex;
+    QHash<RVA, QString> comments;
+    bool valid = false;
+
+    void update(RVA addr);
+};
+
+#endif // COMMENTCACHE_H
@@ -164,6 +164,12 @@ Configuration::Configuration()
 #ifdef IAITO_ENABLE_KSYNTAXHIGHLIGHTING
     kSyntaxHighlightingRepository = nullptr;
 #endif
+    // Connected before anyone else, so colors are up to date in every
+    // receiver
+    connect(this, &Configuration::colorsUpdated, this, [this]() {
+        QMutexLocker locker(&paletteMutex);
+        palette.clear();
+    });
 }
 
 Configuration *Configuration::instance()
@@ -532,6 +538,15 @@ QString Configuration::getLogoFile()
 void Configuration::setColor(const QString &name, const QColor &color)
 {
     s.setValue("colors." + name, color);
+
+    QMutexLocker locker(&paletteMutex);
+    ColorId id = colorId(name);
+    if (name == QLatin1String("other")) {
+        // fallback of every color that is not set
+        palette.clear();
+    } else if (id < palette.size()) {
+        palette[id] = color;
+    }
 }
 
 void Configuration::setLastThemeOf(
@@ -540,7 +555,53 @@ void Configuration::setLastThemeOf(
     s.setValue("lastThemeOf." + currInterfaceTheme.name, theme);
 }
 
-const QColor Configuration::getColor(const QString &name) const
+namespace {
+struct ColorNames
+{
+    QMutex mutex;
+    QHash<QString, Configuration::ColorId> ids;
+    QStringList names;
+};
+
+ColorNames &colorNames()
+{
+    static ColorNames colorNames;
+    return colorNames;
+}
+} // namespace
+
+Configuration::ColorId Configuration::colorId(const QString &name)
+{
+    ColorNames &names = colorNames();
+    QMutexLocker locker(&names.mutex);
+    auto it = names.ids.constFind(name);
+    if (it != names.ids.constEnd()) {
+        return *it;
+    }
+    ColorId id = names.names.size();
+    names.names << name;
+    names.ids.insert(name, id);
+    return id;
+}
+
+const QColor Configuration::getColor(ColorId id) const
+{
+    QMutexLocker locker(&paletteMutex);
+    if (id >= palette.size()) {
+        QStringList names;
+        {
+            ColorNames &colorNames = ::colorNames();
+            QMutexLocker namesLocker(&colorNames.mutex);
+            names = colorNames.names.mid(palette.size());
+        }
+        for (const QString &name : names) {
+            palette << resolveColor(name);
+        }
+    }
+    return id < palette.size() ? palette[id] : QColor();
+}
+
+QColor Configuration::resolveColor(const QString &name) const
 {
     if (s.contains("colors." + name)) {
         return s.value("colors." + name).value<QColor>();
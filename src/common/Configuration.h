@@ -3,10 +3,20 @@
 
 #include <core/Iaito.h>
 #include <QFont>
+#include <QMutex>
 #include <QSettings>
+#include <QVector>
 
 #define Config() (Configuration::instance())
-#define ConfigColor(x) Config()->getColor(x)
+/**
+ * Color of the configuration by name, the name has to be a string literal as it
+ * is only resolved to a Configuration::ColorId the first time.
+ */
+#define ConfigColor(x) \
+    Config()->getColor([]() { \
+        static const Configuration::ColorId id = Configuration::colorId(QStringLiteral(x)); \
+        return id; \
+    }())
 
 #ifdef IAITO_ENABLE_KSYNTAXHIGHLIGHTING
 namespace KSyntaxHighlighting {
@@ -42,6 +52,11 @@ private:
 #endif
     bool outputRedirectEnabled = true;
 
+    // resolved colors indexed by ColorId, filled lazily
+    mutable QVector<QColor> palette;
+    mutable QMutex paletteMutex;
+    QColor resolveColor(const QString &name) const;
+
     Configuration();
     // Colors
     void loadBaseThemeNative();
@@ -134,8 +149,20 @@ public:
     void adjustColorThemeDarkness();
     int colorThemeDarkness(const QString &colorTheme) const;
 
+    /**
+     * @brief Index of a color name in the palette, the same name always gets
+     * the same id.
+     */
+    using ColorId = int;
+    static ColorId colorId(const QString &name);
+
     void setColor(const QString &name, const QColor &color);
-    const QColor getColor(const QString &name) const;
+    const QColor getColor(const QString &name) const { return getColor(colorId(name)); }
+    /**
+     * @brief Color from the palette, which is resolved from the settings again
+     * only when colorsUpdated is emitted.
+     */
+    const QColor getColor(ColorId id) const;
 
     /**
      * @brief Get the value of a config var either from r2 or settings,
@@ -163,9 +190,43 @@ public:
     bool getDecompilerAutoRefreshEnabled();
     void setDecompilerAutoRefreshEnabled(bool enabled);
 
+    /**
+     * @brief Memory budget in MiB for keeping decompiled functions around
+     */
+    int getDecompilerCacheSize() const { return s.value("decompilerCacheSize", 64).toInt(); }
+    void setDecompilerCacheSize(int megabytes) { s.setValue("decompilerCacheSize", megabytes); }
+
+    /**
+     * @brief Whether to decompile in the background the functions likely to be
+     * shown next, how many of them, and which percentage of the time the
+     * decompiler may spend on it
+     */
+    bool getDecompilerPrefetchEnabled() const
+    {
+        return s.value("decompilerPrefetch", false).toBool();
+    }
+    void setDecompilerPrefetchEnabled(bool enabled) { s.setValue("decompilerPrefetch", enabled); }
+    int getDecompilerPrefetchCount() const { return s.value("decompilerPrefetchCount", 4).toInt(); }
+    void setDecompilerPrefetchCount(int count) { s.setValue("decompilerPrefetchCount", count); }
+    int getDecompilerPrefetchBudget() const
+    {
+        return s.value("decompilerPrefetchBudget", 25).toInt();
+    }
+    void setDecompilerPrefetchBudget(int percent)
+    {
+        s.setValue("decompilerPrefetchBudget", percent);
+    }
+
     void enableDecompilerAnnotationHighlighter(bool useDecompilerHighlighter);
     bool isDecompilerAnnotationHighlighterEnabled();
 
+    // Search
+    /**
+     * @brief Number of hits after which the Search widget stops, 0 for no limit
+     */
+    int getSearchMaxHits() const { return s.value("search.maxhits", 10000).toInt(); }
+    void setSearchMaxHits(int hits) { s.setValue("search.maxhits", hits); }
+
     // Graph
     int getGraphBlockMaxChars() const { return s.value("graph.maxcols", 100).toInt(); }
     void setGraphBlockMaxChars(int ch) { s.setValue("graph.maxcols", ch); }
@@ -0,0 +1,68 @@
+#include "ConsoleOutputReader.h"
+#include "core/Iaito.h"
+
+ConsoleOutputReader::ConsoleOutputReader(FILE *mirror)
+    : socket(new QLocalSocket(this))
+    , mirror(mirror)
+{
+    connect(socket, &QIODevice::readyRead, this, &ConsoleOutputReader::read);
+}
+
+void ConsoleOutputReader::read()
+{
+    QStringList lines;
+    // Partial lines are ignored since carriage return is currently unsupported
+    while (socket->canReadLine()) {
+        const QByteArray raw = socket->readLine();
+        if (mirror) {
+            fwrite(raw.constData(), 1, raw.size(), mirror);
+        }
+
+        // Get the last segment that wasn't overwritten by carriage return
+        QString output = QString::fromUtf8(raw).trimmed();
+        output = output.remove(0, output.lastIndexOf('\r')).trimmed();
+        lines << IaitoCore::ansiEscapeToHtml(output);
+    }
+    if (mirror) {
+        fflush(mirror);
+    }
+    if (lines.isEmpty()) {
+        return;
+    }
+
+    bool wasEmpty;
+    {
+        QMutexLocker locker(&mutex);
+        wasEmpty = pending.isEmpty();
+        for (QString &line : lines) {
+            pending.enqueue(std::move(line));
+        }
+        while (pending.size() > MAX_PENDING_LINES) {
+            pending.dequeue();
+            dropped++;
+        }
+    }
+    if (wasEmpty) {
+        emit linesAvailable();
+    }
+}
+
+QStringList ConsoleOutputReader::takeLines(int max, int *dropped)
+{
+    QMutexLocker locker(&mutex);
+    QStringList lines;
+    const int count = qMin(max, pending.size());
+    lines.reserve(count);
+    for (int i = 0; i < count; i++) {
+        lines << pending.dequeue();
+    }
+    *dropped = this->dropped;
+    this->dropped = 0;
+    return lines;
+}
+
+int ConsoleOutputReader::pendingCount()
+{
+    QMutexLocker locker(&mutex);
+    return pending.size();
+}
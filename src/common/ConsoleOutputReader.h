@@ -0,0 +1,65 @@
+#ifndef CONSOLEOUTPUTREADER_H
+#define CONSOLEOUTPUTREADER_H
+
+#include "core/IaitoCommon.h"
+
+#include <QLocalSocket>
+#include <QMutex>
+#include <QObject>
+#include <QQueue>
+#include <QStringList>
+
+#include <cstdio>
+
+/**
+ * @brief Reads the redirected stdout and stderr on its own thread.
+ *
+ * Lines are copied to the original stderr and converted to HTML as they are
+ * read, then queued until the console takes them in batches. The pipe is
+ * drained even while the GUI thread is busy, so r2 never blocks writing to
+ * it. When the console can't keep up the oldest queued lines are dropped
+ * and counted, the queue never holds more than MAX_PENDING_LINES.
+ *
+ * The socket has to be set up with getSocket() before the reader is moved
+ * to its thread.
+ */
+class IAITO_EXPORT ConsoleOutputReader : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param mirror file the output is copied to, may be null
+     */
+    explicit ConsoleOutputReader(FILE *mirror);
+
+    QLocalSocket *getSocket() { return socket; }
+
+    /**
+     * @brief Take up to max lines, oldest first, as HTML
+     * @param dropped set to the number of lines dropped since the last call
+     */
+    QStringList takeLines(int max, int *dropped);
+    int pendingCount();
+
+signals:
+    /**
+     * @brief Emitted when lines are queued while the queue was empty
+     */
+    void linesAvailable();
+
+private slots:
+    void read();
+
+private:
+    static constexpr int MAX_PENDING_LINES = 10000;
+
+    QLocalSocket *socket;
+    FILE *mirror;
+
+    QMutex mutex;
+    QQueue<QString> pending;
+    int dropped = 0;
+};
+
+#endif // CONSOLEOUTPUTREADER_H
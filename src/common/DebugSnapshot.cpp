@@ -0,0 +1,99 @@
+#include "DebugSnapshot.h"
+#include "core/Iaito.h"
+
+#include <algorithm>
+#include <functional>
+
+DebugSnapshot::DebugSnapshot(IaitoCore *core)
+    : QObject(core)
+{
+    // Writes outside of the debug functions, the debug ones invalidate
+    // explicitly before emitting so that the widgets all see the same stop
+    connect(core, &IaitoCore::refreshAll, this, &DebugSnapshot::invalidate);
+    connect(core, &IaitoCore::instructionChanged, this, &DebugSnapshot::invalidate);
+}
+
+void DebugSnapshot::invalidate()
+{
+    generation++;
+}
+
+template<typename T, typename Collect, typename Equal>
+T DebugSnapshot::get(Part<T> &part, quint64 *changed, Collect collect, Equal equal)
+{
+    if (part.collected != generation) {
+        T value = collect();
+        if (!part.collected || !equal(value, part.value)) {
+            part.changed = generation;
+        }
+        part.value = value;
+        part.collected = generation;
+    }
+    if (changed) {
+        *changed = part.changed;
+    }
+    return part.value;
+}
+
+QVector<RegisterRefValueDescription> DebugSnapshot::getRegisterValues(quint64 *changed)
+{
+    return get(
+        registerValues,
+        changed,
+        []() { return Core()->getRegisterRefValues(); },
+        [](const QVector<RegisterRefValueDescription> &a,
+           const QVector<RegisterRefValueDescription> &b) {
+            return std::equal(
+                a.begin(),
+                a.end(),
+                b.begin(),
+                b.end(),
+                [](const RegisterRefValueDescription &x, const RegisterRefValueDescription &y) {
+                    return x.name == y.name && x.value == y.value && x.ref == y.ref;
+                });
+        });
+}
+
+QList<QJsonObject> DebugSnapshot::getRegisterRefs(quint64 *changed)
+{
+    return get(
+        registerRefs,
+        changed,
+        []() { return Core()->getRegisterRefs(); },
+        std::equal_to<QList<QJsonObject>>());
+}
+
+QList<QJsonObject> DebugSnapshot::getStack(quint64 *changed)
+{
+    return get(
+        stack, changed, []() { return Core()->getStack(); }, std::equal_to<QList<QJsonObject>>());
+}
+
+QJsonArray DebugSnapshot::getBacktrace(quint64 *changed)
+{
+    return get(
+        backtrace,
+        changed,
+        []() { return Core()->getBacktrace().array(); },
+        std::equal_to<QJsonArray>());
+}
+
+QList<MemoryMapDescription> DebugSnapshot::getMemoryMap(quint64 *changed)
+{
+    return get(
+        memoryMap,
+        changed,
+        []() { return Core()->getMemoryMap(); },
+        [](const QList<MemoryMapDescription> &a, const QList<MemoryMapDescription> &b) {
+            return std::equal(
+                a.begin(),
+                a.end(),
+                b.begin(),
+                b.end(),
+                [](const MemoryMapDescription &x, const MemoryMapDescription &y) {
+                    return x.addrStart == y.addrStart && x.addrEnd == y.addrEnd
+                           && x.name == y.name && x.fileName == y.fileName && x.type == y.type
+                           && x.permission == y.permission;
+                });
+        });
+}
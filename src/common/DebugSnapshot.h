@@ -0,0 +1,87 @@
+#ifndef DEBUGSNAPSHOT_H
+#define DEBUGSNAPSHOT_H
+
+#include "core/IaitoCommon.h"
+#include "core/IaitoDescriptions.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QObject>
+#include <QVector>
+
+class IaitoCore;
+
+/**
+ * @brief State of the debuggee at the current stop, shared by the debug
+ * widgets.
+ *
+ * The core starts a new stop generation whenever the debuggee may have
+ * changed: a debug task finished, a register or the stack was written or
+ * everything is refreshed. Each part is collected from r2 the first time a
+ * widget asks for it in a generation, so a stop costs one query per part no
+ * matter how many widgets are open or how many signals they get.
+ *
+ * The getters also return the generation the part last changed in. Widgets
+ * remember the one they show and skip the update when it did not move, so
+ * a part that is the same as at the previous stop is not redrawn.
+ *
+ * Only used from the GUI thread.
+ */
+class IAITO_EXPORT DebugSnapshot : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DebugSnapshot(IaitoCore *core);
+
+    quint64 getGeneration() const { return generation; }
+
+    /**
+     * @brief Start a new stop generation, parts are collected again on next use
+     */
+    void invalidate();
+
+    /**
+     * @param changed set to the generation the part last changed in
+     */
+    QVector<RegisterRefValueDescription> getRegisterValues(quint64 *changed = nullptr);
+    /**
+     * @brief Registers with their telescoped references
+     * @see IaitoCore::getRegisterRefs()
+     */
+    QList<QJsonObject> getRegisterRefs(quint64 *changed = nullptr);
+    /**
+     * @brief Telescoped stack window from the stack pointer
+     * @see IaitoCore::getStack()
+     */
+    QList<QJsonObject> getStack(quint64 *changed = nullptr);
+    QJsonArray getBacktrace(quint64 *changed = nullptr);
+    /**
+     * @param changed set to the generation the maps last changed in, they
+     * rarely do between two stops
+     */
+    QList<MemoryMapDescription> getMemoryMap(quint64 *changed = nullptr);
+
+private:
+    template<typename T>
+    struct Part
+    {
+        T value;
+        // generation it was collected in, 0 if never
+        quint64 collected = 0;
+        quint64 changed = 0;
+    };
+
+    quint64 generation = 1;
+
+    Part<QVector<RegisterRefValueDescription>> registerValues;
+    Part<QList<QJsonObject>> registerRefs;
+    Part<QList<QJsonObject>> stack;
+    Part<QJsonArray> backtrace;
+    Part<QList<MemoryMapDescription>> memoryMap;
+
+    template<typename T, typename Collect, typename Equal>
+    T get(Part<T> &part, quint64 *changed, Collect collect, Equal equal);
+};
+
+#endif // DEBUGSNAPSHOT_H
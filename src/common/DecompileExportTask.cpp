@@ -0,0 +1,332 @@
+#include "DecompileExportTask.h"
+#include "common/Configuration.h"
+#include "common/Decompiler.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QQueue>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <memory>
+#include <vector>
+
+namespace {
+// printed by the workers before each function, only letters so that r2 does
+// not parse it
+const char MARKER[] = "iaito-export-begin ";
+const int MAX_NAME_LENGTH = 100;
+} // namespace
+
+struct DecompileExportTask::Worker
+{
+    int id = 0;
+    std::unique_ptr<QProcess> process;
+    // indices in functions, in the order they are decompiled
+    QVector<int> shard;
+    QString outputPath;
+    qint64 outputSize = 0;
+    QElapsedTimer idle;
+};
+
+DecompileExportTask::DecompileExportTask(
+    Decompiler *decompiler, const QList<RVA> &addrs, const QString &dir)
+    : decompilerId(decompiler->getId())
+    , command(decompiler->getBatchCommand())
+    , dir(dir)
+{
+    program = QStandardPaths::findExecutable(QStringLiteral("radare2"));
+    if (program.isEmpty()) {
+        program = QStringLiteral("radare2");
+    }
+
+    {
+        RCoreReadLocked core(Core());
+        if (addrs.isEmpty()) {
+            RListIter *it;
+            RAnalFunction *fcn;
+            IaitoRListForeach(core->anal->fcns, it, RAnalFunction, fcn)
+            {
+                functions.append({fcn->addr, QString::fromUtf8(fcn->name)});
+            }
+        } else {
+            for (RVA addr : addrs) {
+                RAnalFunction *fcn = r_anal_get_function_at(core->anal, addr);
+                if (fcn) {
+                    functions.append({fcn->addr, QString::fromUtf8(fcn->name)});
+                }
+            }
+        }
+
+        binary = QString::fromUtf8(r_config_get(core->config, "file.path"));
+        bool va = r_config_get_b(core->config, "io.va");
+        arguments << QStringLiteral("-q") << QStringLiteral("-N");
+        arguments << QStringLiteral("-e") << QStringLiteral("scr.color=0");
+        arguments << QStringLiteral("-e") << QStringLiteral("scr.interactive=false");
+        for (const char *key : {"io.va", "bin.cache", "bin.demangle"}) {
+            arguments << QStringLiteral("-e")
+                      << QStringLiteral("%1=%2").arg(
+                             QString::fromUtf8(key),
+                             QString::fromUtf8(r_config_get(core->config, key)));
+        }
+        if (va) {
+            arguments << QStringLiteral("-B") << RAddressString(r_bin_get_baddr(core->bin));
+        }
+    }
+    for (Function &function : functions) {
+        function.file = fileName(function);
+    }
+
+    // Replay what the decompilers depend on: the cpu, the names, the function
+    // boundaries and the comments
+    QStringList script;
+    for (const char *key : {"asm.arch", "asm.bits", "asm.cpu", "asm.os", "cfg.bigendian"}) {
+        script << QStringLiteral("e %1=%2").arg(QString::fromUtf8(key), Core()->getConfig(key));
+    }
+    script << QStringLiteral("fs *");
+    script << Core()->cmdRaw("f*");
+    script << Core()->cmdRaw("afl*");
+    script << Core()->cmdRaw("CC*");
+    analysisScript = script.join(QLatin1Char('\n')) + QLatin1Char('\n');
+}
+
+Decompiler *DecompileExportTask::exportDecompiler()
+{
+    Decompiler *selected = Core()->getDecompilerById(Config()->getSelectedDecompiler());
+    if (selected && !selected->getBatchCommand().isEmpty()) {
+        return selected;
+    }
+    for (Decompiler *decompiler : Core()->getDecompilers()) {
+        if (!decompiler->getBatchCommand().isEmpty()) {
+            return decompiler;
+        }
+    }
+    return nullptr;
+}
+
+void DecompileExportTask::runTask()
+{
+    if (functions.isEmpty()) {
+        log(tr("No functions to decompile."));
+        return;
+    }
+    if (binary.isEmpty() || !QFileInfo::exists(binary)) {
+        log(tr("Only files on disk can be decompiled out of process."));
+        failed = functions.size();
+        return;
+    }
+    if (!QDir().mkpath(dir)) {
+        log(tr("Cannot create %1").arg(dir));
+        failed = functions.size();
+        return;
+    }
+    QTemporaryDir tmp;
+    QFile analysisFile(tmp.filePath(QStringLiteral("analysis.r2")));
+    if (!tmp.isValid() || !analysisFile.open(QIODevice::WriteOnly)
+        || analysisFile.write(analysisScript.toUtf8()) < 0) {
+        log(tr("Cannot write the analysis script"));
+        failed = functions.size();
+        return;
+    }
+    analysisFile.close();
+
+    const int maxWorkers = qBound(1, QThread::idealThreadCount(), functions.size());
+    const int shardSize
+        = qBound(1, (functions.size() + maxWorkers - 1) / maxWorkers, MAX_SHARD_SIZE);
+    QQueue<QVector<int>> pending;
+    for (int i = 0; i < functions.size(); i += shardSize) {
+        QVector<int> shard;
+        for (int j = i; j < qMin(i + shardSize, functions.size()); j++) {
+            shard << j;
+        }
+        pending.enqueue(shard);
+    }
+    log(tr("Decompiling %1 functions with %2 using %3 workers")
+            .arg(functions.size())
+            .arg(decompilerId)
+            .arg(maxWorkers));
+
+    std::vector<Worker> workers;
+    int nextId = 0;
+    int done = 0;
+    while (!pending.isEmpty() || !workers.empty()) {
+        if (isInterrupted()) {
+            for (Worker &worker : workers) {
+                worker.process->kill();
+                worker.process->waitForFinished();
+            }
+            log(tr("Interrupted, %1 functions were not decompiled").arg(functions.size() - done));
+            break;
+        }
+        while (int(workers.size()) < maxWorkers && !pending.isEmpty()) {
+            Worker worker;
+            worker.id = nextId++;
+            worker.shard = pending.dequeue();
+            if (!startWorker(worker, tmp.path())) {
+                log(tr("Cannot run %1").arg(program));
+                for (Worker &running : workers) {
+                    running.process->kill();
+                    running.process->waitForFinished();
+                }
+                failed = functions.size() - written;
+                writeIndex();
+                return;
+            }
+            workers.push_back(std::move(worker));
+        }
+
+        const int wait = qMax(1, POLL_MS / int(workers.size()));
+        for (auto it = workers.begin(); it != workers.end();) {
+            Worker &worker = *it;
+            bool crashed = false;
+            if (!worker.process->waitForFinished(wait)) {
+                qint64 size = QFileInfo(worker.outputPath).size();
+                if (size != worker.outputSize) {
+                    worker.outputSize = size;
+                    worker.idle.restart();
+                    ++it;
+                    continue;
+                }
+                if (!worker.idle.hasExpired(FUNCTION_TIMEOUT_MS)) {
+                    ++it;
+                    continue;
+                }
+                log(tr("A worker stopped responding, killing it"));
+                worker.process->kill();
+                worker.process->waitForFinished();
+                crashed = true;
+            }
+            crashed = crashed || worker.process->exitStatus() != QProcess::NormalExit
+                      || worker.process->exitCode() != 0;
+            QVector<int> rest = collectOutput(worker, crashed);
+            done += worker.shard.size() - rest.size();
+            if (!rest.isEmpty()) {
+                pending.enqueue(rest);
+            }
+            log(tr("Decompiled %1/%2 functions").arg(done).arg(functions.size()));
+            it = workers.erase(it);
+        }
+    }
+    writeIndex();
+}
+
+bool DecompileExportTask::startWorker(Worker &worker, const QString &tmpDir)
+{
+    const QDir tmp(tmpDir);
+    const QString name = QStringLiteral("shard%1").arg(worker.id);
+    QFile script(tmp.filePath(name + QStringLiteral(".r2")));
+    if (!script.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    for (int i : worker.shard) {
+        const QString addr = RAddressString(functions[i].addr);
+        script.write(QStringLiteral("?e %1%2\n%3 @ %2\n")
+                         .arg(QLatin1String(MARKER), addr, command)
+                         .toUtf8());
+    }
+    script.close();
+
+    worker.outputPath = tmp.filePath(name + QStringLiteral(".out"));
+    worker.process.reset(new QProcess);
+    worker.process->setStandardOutputFile(worker.outputPath);
+    worker.process->setStandardErrorFile(QProcess::nullDevice());
+    QStringList args = arguments;
+    args << QStringLiteral("-i") << tmp.filePath(QStringLiteral("analysis.r2"));
+    args << QStringLiteral("-i") << script.fileName() << binary;
+    worker.process->start(program, args);
+    worker.idle.start();
+    return worker.process->waitForStarted();
+}
+
+QVector<int> DecompileExportTask::collectOutput(const Worker &worker, bool crashed)
+{
+    int reached = 0;
+    QByteArray code;
+    auto write = [this, &worker, &reached, &code]() {
+        Function &function = functions[worker.shard[reached - 1]];
+        QFile file(QDir(dir).filePath(function.file));
+        if (!code.trimmed().isEmpty() && file.open(QIODevice::WriteOnly)
+            && file.write(code) == code.size()) {
+            function.ok = true;
+            written++;
+        } else {
+            failed++;
+        }
+    };
+
+    QFile output(worker.outputPath);
+    if (output.open(QIODevice::ReadOnly)) {
+        while (!output.atEnd()) {
+            QByteArray line = output.readLine();
+            if (line.startsWith(MARKER) && reached < worker.shard.size()) {
+                if (reached) {
+                    write();
+                }
+                reached++;
+                code.clear();
+            } else if (reached) {
+                code += line;
+            }
+        }
+    }
+
+    if (!crashed) {
+        if (reached) {
+            write();
+        }
+        // exited early without a crash, running it again would do the same
+        failed += worker.shard.size() - reached;
+        return {};
+    }
+    if (!reached) {
+        // died before the first function, likely on the file or the script
+        failed += worker.shard.size();
+        return {};
+    }
+    // Give up the function it was on and retry the others
+    failed++;
+    return worker.shard.mid(reached);
+}
+
+void DecompileExportTask::writeIndex()
+{
+    QJsonArray entries;
+    for (const Function &function : std::as_const(functions)) {
+        QJsonObject entry;
+        entry[QStringLiteral("addr")] = RAddressString(function.addr);
+        entry[QStringLiteral("name")] = function.name;
+        entry[QStringLiteral("file")] = function.ok ? function.file : QString();
+        entry[QStringLiteral("ok")] = function.ok;
+        entries.append(entry);
+    }
+    QJsonObject index;
+    index[QStringLiteral("binary")] = binary;
+    index[QStringLiteral("decompiler")] = decompilerId;
+    index[QStringLiteral("functions")] = entries;
+
+    QFile file(QDir(dir).filePath(QStringLiteral("index.json")));
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(index).toJson()) < 0) {
+        log(tr("Cannot write %1").arg(file.fileName()));
+        return;
+    }
+    log(tr("Wrote %1 files, %2 functions failed").arg(written).arg(failed));
+}
+
+QString DecompileExportTask::fileName(const Function &function)
+{
+    QString name = function.name.left(MAX_NAME_LENGTH);
+    for (QChar &c : name) {
+        if (!c.isLetterOrNumber() && c != QLatin1Char('_') && c != QLatin1Char('.')
+            && c != QLatin1Char('-')) {
+            c = QLatin1Char('_');
+        }
+    }
+    return QStringLiteral("%1_%2.c").arg(RAddressString(function.addr), name);
+}
@@ -0,0 +1,91 @@
+#ifndef DECOMPILEEXPORTTASK_H
+#define DECOMPILEEXPORTTASK_H
+
+#include "common/AsyncTask.h"
+#include "core/Iaito.h"
+
+#include <QStringList>
+#include <QVector>
+
+class Decompiler;
+
+/**
+ * @brief Decompiles a set of functions and writes one .c file per function
+ * plus an index.json to a directory.
+ *
+ * r_cons and most of the decompiler plugins keep global state, so functions
+ * can't be decompiled in parallel in this process. The task instead starts a
+ * pool of radare2 processes on the same file, replays the flags, functions
+ * and comments of the current session in each of them and hands them shards
+ * of the function list. A worker that crashes or stops printing costs only
+ * the function it was on, the rest of its shard goes back to the queue.
+ *
+ * The core is only read in the constructor, runTask() does not touch it.
+ */
+class DecompileExportTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param decompiler must have a batch command
+     * @param addrs functions to decompile, every function if empty
+     * @param dir directory to write the files to, created if missing
+     */
+    DecompileExportTask(Decompiler *decompiler, const QList<RVA> &addrs, const QString &dir);
+
+    QString getTitle() override { return tr("Decompiling to %1").arg(dir); }
+
+    /**
+     * @brief The selected decompiler, or the first one that can run out of
+     * process if it can't
+     * @return nullptr if no decompiler can
+     */
+    static Decompiler *exportDecompiler();
+
+    int getFunctionCount() const { return functions.size(); }
+    int getWrittenCount() const { return written; }
+    int getFailedCount() const { return failed; }
+
+protected:
+    void runTask() override;
+
+private:
+    static constexpr int MAX_SHARD_SIZE = 256;
+    static constexpr int POLL_MS = 100;
+    // a worker that prints nothing for that long is killed
+    static constexpr int FUNCTION_TIMEOUT_MS = 5 * 60 * 1000;
+
+    struct Function
+    {
+        RVA addr;
+        QString name;
+        QString file;
+        bool ok = false;
+    };
+
+    struct Worker;
+
+    QVector<Function> functions;
+    QString decompilerId;
+    QString command;
+    QString dir;
+    QString program;
+    QString binary;
+    QStringList arguments;
+    QString analysisScript;
+
+    int written = 0;
+    int failed = 0;
+
+    bool startWorker(Worker &worker, const QString &tmpDir);
+    /**
+     * @brief Write the functions found in the output of a finished worker
+     * @return indices of the functions it did not get to
+     */
+    QVector<int> collectOutput(const Worker &worker, bool crashed);
+    void writeIndex();
+    static QString fileName(const Function &function);
+};
+
+#endif // DECOMPILEEXPORTTASK_H
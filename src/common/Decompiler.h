@@ -34,6 +34,13 @@ public:
     virtual RCodeMeta *decompileSync(RVA addr) = 0;
     virtual void cancel() {}
 
+    /**
+     * @brief radare2 command printing the function at the current seek as
+     * plain C, used to decompile in separate radare2 processes.
+     * @return empty if the decompiler can only run in this process
+     */
+    virtual QString getBatchCommand() const { return QString(); }
+
 signals:
     void finished(RCodeMeta *codeDecompiled);
 };
@@ -49,6 +56,7 @@ public:
     explicit R2DecDecompiler(QObject *parent = nullptr);
     RCodeMeta *decompileSync(RVA addr) override;
     void decompileAt(RVA addr) override;
+    QString getBatchCommand() const override { return QStringLiteral("pdd"); }
 
     bool isRunning() override { return task != nullptr; }
 
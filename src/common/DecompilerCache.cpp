@@ -0,0 +1,97 @@
+#include "DecompilerCache.h"
+#include "common/Configuration.h"
+#include "core/Iaito.h"
+
+#include <cstring>
+
+DecompilerCache::DecompilerCache(IaitoCore *core)
+    : QObject(core)
+{
+    auto invalidateAll = [this]() { invalidate(); };
+    // Names of other functions and flags show up in the code
+    connect(core, &IaitoCore::refreshAll, this, invalidateAll);
+    connect(core, &IaitoCore::codeRebased, this, invalidateAll);
+    connect(core, &IaitoCore::functionsChanged, this, invalidateAll);
+    connect(core, &IaitoCore::functionRenamed, this, invalidateAll);
+    connect(core, &IaitoCore::flagsChanged, this, invalidateAll);
+    connect(core, &IaitoCore::varsChanged, this, invalidateAll);
+    connect(core, &IaitoCore::asmOptionsChanged, this, invalidateAll);
+    connect(core, &IaitoCore::ioCacheChanged, this, invalidateAll);
+    connect(core, &IaitoCore::writeModeChanged, this, invalidateAll);
+    connect(core, &IaitoCore::ioModeChanged, this, invalidateAll);
+    connect(core, &IaitoCore::commentsChanged, this, &DecompilerCache::invalidateFunctionsAt);
+    connect(core, &IaitoCore::instructionChanged, this, &DecompilerCache::invalidateFunctionsAt);
+}
+
+quint64 DecompilerCache::generation(RVA function)
+{
+    QMutexLocker locker(&mutex);
+    // Both only grow, so the sum changes whenever one of them does
+    return globalGeneration + functionGenerations.value(function);
+}
+
+DecompilerCache::Code DecompilerCache::find(const QString &decompiler, RVA function)
+{
+    QMutexLocker locker(&mutex);
+    const Entry *entry = entries.object(qMakePair(decompiler, function));
+    if (!entry || entry->generation != globalGeneration + functionGenerations.value(function)) {
+        return nullptr;
+    }
+    return entry->code;
+}
+
+void DecompilerCache::insert(
+    const QString &decompiler, RVA function, quint64 generation, const Code &code)
+{
+    if (!code || !code->code) {
+        return;
+    }
+    int budget = Config()->getDecompilerCacheSize() * 1024 * 1024;
+    QMutexLocker locker(&mutex);
+    if (generation != globalGeneration + functionGenerations.value(function)) {
+        return;
+    }
+    if (entries.maxCost() != budget) {
+        entries.setMaxCost(budget);
+    }
+    size_t cost = strlen(code->code) + r_vector_len(&code->annotations) * sizeof(RCodeMetaItem);
+    entries.insert(qMakePair(decompiler, function), new Entry{generation, code}, int(cost));
+}
+
+void DecompilerCache::invalidate(RVA function)
+{
+    QMutexLocker locker(&mutex);
+    functionGenerations[function]++;
+    const auto keys = entries.keys();
+    for (const auto &key : keys) {
+        if (key.second == function) {
+            entries.remove(key);
+        }
+    }
+}
+
+void DecompilerCache::invalidate()
+{
+    QMutexLocker locker(&mutex);
+    globalGeneration++;
+    entries.clear();
+}
+
+void DecompilerCache::invalidateFunctionsAt(RVA addr)
+{
+    QVector<RVA> functions;
+    {
+        RCoreReadLocked core(Core());
+        RList *fcns = r_anal_get_functions_in(core->anal, addr);
+        RListIter *it;
+        RAnalFunction *fcn;
+        IaitoRListForeach(fcns, it, RAnalFunction, fcn)
+        {
+            functions << fcn->addr;
+        }
+        r_list_free(fcns);
+    }
+    for (RVA function : functions) {
+        invalidate(function);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef DECOMPILERCACHE_H
+#define DECOMPILERCACHE_H
+
+#include "core/IaitoCommon.h"
+
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+
+#include <memory>
+
+class IaitoCore;
+
+/**
+ * @brief Recently decompiled functions, per decompiler.
+ *
+ * Every function has a generation that grows whenever something its code
+ * depends on changes: one of its instructions, comments or variables, or
+ * anything global like flags, function names or the whole analysis. Entries
+ * are only returned for the generation they were decompiled at, so coming back
+ * to a function that did not change needs no decompiler run. The least
+ * recently used entries are dropped once the budget of
+ * Configuration::getDecompilerCacheSize() is exceeded.
+ */
+class IAITO_EXPORT DecompilerCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Code = std::shared_ptr<RCodeMeta>;
+
+    explicit DecompilerCache(IaitoCore *core);
+
+    /**
+     * @brief Current generation of function, to pass to insert() once the
+     * decompilation started now is done
+     */
+    quint64 generation(RVA function);
+    /**
+     * @return code of function if it is cached for its current generation
+     */
+    Code find(const QString &decompiler, RVA function);
+    /**
+     * @brief Cache the code of function, unless it changed since generation
+     */
+    void insert(const QString &decompiler, RVA function, quint64 generation, const Code &code);
+
+    /**
+     * @brief Drop the code of function for every decompiler
+     */
+    void invalidate(RVA function);
+    /**
+     * @brief Drop everything
+     */
+    void invalidate();
+
+private:
+    struct Entry
+    {
+        quint64 generation;
+        Code code;
+    };
+
+    QMutex mutex;
+    QCache<QPair<QString, RVA>, Entry> entries;
+    // bumped by changes affecting every function
+    quint64 globalGeneration = 0;
+    // bumped by changes to a single function
+    QHash<RVA, quint64> functionGenerations;
+
+    void invalidateFunctionsAt(RVA addr);
+};
+
+#endif // DECOMPILERCACHE_H
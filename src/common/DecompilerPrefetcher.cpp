@@ -0,0 +1,114 @@
+#include "DecompilerPrefetcher.h"
+#include "common/Configuration.h"
+#include "common/Decompiler.h"
+#include "common/DecompilerCache.h"
+#include "core/Iaito.h"
+
+DecompilerPrefetcher::DecompilerPrefetcher(IaitoCore *core)
+    : QObject(core)
+{
+    timer.setSingleShot(true);
+    connect(&timer, &QTimer::timeout, this, &DecompilerPrefetcher::next);
+
+    // The queued addresses may not be functions anymore
+    connect(core, &IaitoCore::refreshAll, this, &DecompilerPrefetcher::clear);
+    connect(core, &IaitoCore::codeRebased, this, &DecompilerPrefetcher::clear);
+    connect(core, &IaitoCore::functionsChanged, this, &DecompilerPrefetcher::clear);
+}
+
+void DecompilerPrefetcher::functionShown(Decompiler *decompiler, RVA function)
+{
+    recent.removeAll(function);
+    recent.prepend(function);
+    while (recent.size() > MAX_RECENT) {
+        recent.removeLast();
+    }
+    if (!decompiler || !Config()->getDecompilerPrefetchEnabled()) {
+        return;
+    }
+
+    QList<RVA> candidates;
+    for (const XrefDescription &xref : Core()->getXRefs(function, false, true, "CALL", false)) {
+        if (Core()->getFunctionStart(xref.to) == xref.to) {
+            candidates << xref.to;
+        }
+    }
+    candidates << recent.mid(1);
+
+    // Most likely first, the newest function shown replaces the previous queue
+    DecompilerCache *cache = Core()->getDecompilerCache();
+    const int count = Config()->getDecompilerPrefetchCount();
+    this->decompiler = decompiler;
+    queue.clear();
+    for (RVA candidate : std::as_const(candidates)) {
+        if (queue.size() >= count) {
+            break;
+        }
+        if (candidate != function && candidate != running && !queue.contains(candidate)
+            && !cache->find(decompiler->getId(), candidate)) {
+            queue << candidate;
+        }
+    }
+    if (running == RVA_INVALID && !queue.isEmpty() && !timer.isActive()) {
+        timer.start(BUSY_RETRY_MS);
+    }
+}
+
+void DecompilerPrefetcher::clear()
+{
+    queue.clear();
+    recent.clear();
+}
+
+void DecompilerPrefetcher::next()
+{
+    if (running != RVA_INVALID || queue.isEmpty() || !decompiler) {
+        return;
+    }
+    // Foreground decompilations and analysis come first
+    if (decompiler->isRunning() || Core()->getAsyncTaskManager()->getTasksRunning()) {
+        timer.start(BUSY_RETRY_MS);
+        return;
+    }
+
+    DecompilerCache *cache = Core()->getDecompilerCache();
+    running = queue.takeFirst();
+    if (cache->find(decompiler->getId(), running)) {
+        running = RVA_INVALID;
+        timer.start(0);
+        return;
+    }
+    runningGeneration = cache->generation(running);
+    runningDecompiler = decompiler;
+    runningId = decompiler->getId();
+    runningTimer.start();
+#if MONOTHREAD
+    finished(runningDecompiler->decompileSync(running));
+#else
+    finishedConnection = connect(
+        runningDecompiler, &Decompiler::finished, this, &DecompilerPrefetcher::finished);
+    runningDecompiler->decompileAt(running);
+#endif
+}
+
+void DecompilerPrefetcher::finished(RCodeMeta *code)
+{
+    disconnect(finishedConnection);
+    if (code) {
+        std::shared_ptr<RCodeMeta> decompiled(code, &r_codemeta_free);
+        // Warnings have no annotations, only keep actual code around
+        if (r_vector_len(&code->annotations)) {
+            Core()->getDecompilerCache()->insert(runningId, running, runningGeneration, decompiled);
+        }
+    }
+    running = RVA_INVALID;
+    runningDecompiler.clear();
+
+    if (!queue.isEmpty()) {
+        // Stay idle long enough for the decompiler to only use its share of
+        // the time
+        int budget = qBound(1, Config()->getDecompilerPrefetchBudget(), 100);
+        qint64 elapsed = runningTimer.elapsed();
+        timer.start(int(qMin<qint64>(elapsed * (100 - budget) / budget, 60 * 1000)));
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef DECOMPILERPREFETCHER_H
+#define DECOMPILERPREFETCHER_H
+
+#include "core/IaitoCommon.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+class Decompiler;
+class IaitoCore;
+
+/**
+ * @brief Decompiles in the background the functions likely to be shown next
+ * and puts them in the DecompilerCache.
+ *
+ * Once a function is shown, its direct callees followed by the recently shown
+ * functions are queued, up to Configuration::getDecompilerPrefetchCount().
+ * They are decompiled one at a time with Decompiler::decompileAt(), only
+ * while the decompiler and the task manager are idle, and with pauses so the
+ * decompiler only runs for the configured share of the time.
+ *
+ * With a single threaded core (MONOTHREAD) Decompiler::decompileSync() is
+ * called from the timer instead, so each prefetch holds the GUI thread for
+ * one function and the pauses keep it responsive in between.
+ */
+class IAITO_EXPORT DecompilerPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DecompilerPrefetcher(IaitoCore *core);
+
+    /**
+     * @brief function was just shown using decompiler, queue what may follow
+     */
+    void functionShown(Decompiler *decompiler, RVA function);
+
+private:
+    // wait before checking again while something else runs
+    static constexpr int BUSY_RETRY_MS = 500;
+    // functions remembered as recently shown
+    static constexpr int MAX_RECENT = 16;
+
+    QPointer<Decompiler> decompiler;
+    QList<RVA> queue;
+    QList<RVA> recent;
+    QTimer timer;
+
+    // function being decompiled, RVA_INVALID if none, and by what
+    RVA running = RVA_INVALID;
+    QPointer<Decompiler> runningDecompiler;
+    QString runningId;
+    quint64 runningGeneration = 0;
+    QElapsedTimer runningTimer;
+    QMetaObject::Connection finishedConnection;
+
+    void clear();
+    void next();
+    void finished(RCodeMeta *code);
+};
+
+#endif // DECOMPILERPREFETCHER_H
@@ -0,0 +1,281 @@
+#include "DensityIndex.h"
+#include "core/Iaito.h"
+
+#include <utility>
+
+namespace {
+struct FlagsCount
+{
+    RVA from;
+    RVA step;
+    QList<BlockDescription> *buckets;
+};
+
+bool countFlag(RFlagItem *fi, void *user)
+{
+    auto count = reinterpret_cast<FlagsCount *>(user);
+    RVA bucket = (ADDRESS_OF(fi) - count->from) / count->step;
+    if (bucket < static_cast<RVA>(count->buckets->size())) {
+        (*count->buckets)[static_cast<int>(bucket)].flags++;
+    }
+    return true;
+}
+} // namespace
+
+DensityIndex::DensityIndex(IaitoCore *core)
+    : QObject(core)
+{
+    connect(core, &IaitoCore::refreshAll, this, [this]() { markDirty(AllLayers); });
+    connect(core, &IaitoCore::codeRebased, this, [this]() { markDirty(AllLayers); });
+    connect(core, &IaitoCore::functionsChanged, this, [this]() { markDirty(Functions); });
+    connect(core, &IaitoCore::flagsChanged, this, [this]() { markDirty(Flags); });
+    connect(core, &IaitoCore::commentsChanged, this, [this](RVA addr) {
+        QMutexLocker locker(&mutex);
+        dirtyComments.insert(addr);
+    });
+}
+
+bool DensityIndex::statistics(unsigned int blocksCount, BlockStatistics &stats)
+{
+    QMutexLocker locker(&mutex);
+    update();
+    if (levels.isEmpty()) {
+        return false;
+    }
+
+    // Coarsest level that still has enough blocks
+    int level = 0;
+    while (level + 1 < levels.size() && levels[level + 1].size() >= int(blocksCount)) {
+        level++;
+    }
+    stats.from = from;
+    stats.to = to;
+    stats.blocksize = step << level;
+    stats.blocks = levels[level];
+    return true;
+}
+
+void DensityIndex::invalidate()
+{
+    markDirty(AllLayers);
+}
+
+void DensityIndex::markDirty(int layers)
+{
+    QMutexLocker locker(&mutex);
+    dirtyLayers |= layers;
+}
+
+void DensityIndex::update()
+{
+    if (!dirtyLayers && dirtyComments.isEmpty()) {
+        return;
+    }
+    RCoreReadLocked core(Core());
+
+    if (dirtyLayers & Bounds) {
+        updateBounds(core);
+        dirtyLayers = AllLayers;
+    }
+    if (levels.isEmpty()) {
+        dirtyLayers = 0;
+        dirtyComments.clear();
+        return;
+    }
+    if (dirtyLayers & Functions) {
+        countFunctions(core);
+    }
+    if (dirtyLayers & Flags) {
+        countFlags(core);
+    }
+    if (dirtyLayers & Symbols) {
+        countSymbols(core);
+    }
+    if (dirtyLayers & Meta) {
+        countMeta(core);
+    } else {
+        QSet<int> buckets;
+        for (RVA addr : std::as_const(dirtyComments)) {
+            int bucket = bucketAt(addr);
+            if (bucket >= 0 && !buckets.contains(bucket)) {
+                buckets.insert(bucket);
+                countComments(core, bucket);
+            }
+        }
+    }
+    dirtyLayers = 0;
+    dirtyComments.clear();
+    buildLevels();
+}
+
+void DensityIndex::updateBounds(RCore *core)
+{
+    // Same boundaries as search.in=bin.sections, so that the Visual Navbar
+    // shows all the relevant addresses.
+    from = RVA_MAX;
+    to = 0;
+    RListIter *it;
+    RBinSection *sect;
+    IaitoRListForeach(r_bin_get_sections(core->bin), it, RBinSection, sect)
+    {
+        if (sect->is_segment || !sect->vsize) {
+            continue;
+        }
+        from = qMin(from, static_cast<RVA>(sect->vaddr));
+        to = qMax(to, static_cast<RVA>(sect->vaddr + sect->vsize));
+    }
+    levels.clear();
+    if (from >= to) {
+        return;
+    }
+
+    RVA range = to - from;
+    step = qMax<RVA>(range / LEAF_COUNT + (range % LEAF_COUNT ? 1 : 0), 1);
+    int count = static_cast<int>(range / step + (range % step ? 1 : 0));
+    QList<BlockDescription> leaves;
+    leaves.reserve(count);
+    for (int i = 0; i < count; i++) {
+        BlockDescription block = {};
+        block.addr = from + i * step;
+        block.size = qMin(step, to - block.addr);
+        RIOMap *map = r_io_map_get_at(core->io, block.addr);
+        int perm = map ? map->perm : 0;
+        block.rwx = ((perm & R_PERM_R) ? (1 << 0) : 0) | ((perm & R_PERM_W) ? (1 << 1) : 0)
+                    | ((perm & R_PERM_X) ? (1 << 2) : 0);
+        leaves << block;
+    }
+    levels << leaves;
+}
+
+void DensityIndex::countFunctions(RCore *core)
+{
+    QList<BlockDescription> &leaves = levels[0];
+    for (BlockDescription &block : leaves) {
+        block.functions = 0;
+        block.inFunctions = 0;
+    }
+    RListIter *it;
+    RAnalFunction *fcn;
+    IaitoRListForeach(core->anal->fcns, it, RAnalFunction, fcn)
+    {
+        int bucket = bucketAt(fcn->addr);
+        if (bucket < 0) {
+            continue;
+        }
+        leaves[bucket].functions++;
+        RVA size = qMax<RVA>(r_anal_function_linear_size(fcn), 1);
+        int lastBucket = bucketAt(qMin(fcn->addr + size - 1, to - 1));
+        if (lastBucket < 0) {
+            lastBucket = leaves.size() - 1;
+        }
+        for (; bucket <= lastBucket; bucket++) {
+            leaves[bucket].inFunctions++;
+        }
+    }
+}
+
+void DensityIndex::countFlags(RCore *core)
+{
+    for (BlockDescription &block : levels[0]) {
+        block.flags = 0;
+    }
+    FlagsCount count = {from, step, &levels[0]};
+    r_flag_foreach_range(core->flags, from, to, countFlag, &count);
+}
+
+void DensityIndex::countSymbols(RCore *core)
+{
+    QList<BlockDescription> &leaves = levels[0];
+    for (BlockDescription &block : leaves) {
+        block.symbols = 0;
+    }
+    RListIter *it;
+    RBinSymbol *sym;
+    IaitoRListForeach(r_bin_get_symbols(core->bin), it, RBinSymbol, sym)
+    {
+        int bucket = bucketAt(sym->vaddr);
+        if (bucket >= 0) {
+            leaves[bucket].symbols++;
+        }
+    }
+}
+
+void DensityIndex::countMeta(RCore *core)
+{
+    QList<BlockDescription> &leaves = levels[0];
+    for (BlockDescription &block : leaves) {
+        block.strings = 0;
+        block.comments = 0;
+    }
+    if (!core->anal->meta.root) {
+        return;
+    }
+    RIntervalTreeIter it = r_rbtree_first(&core->anal->meta.root->node);
+    for (; r_rbtree_iter_has(&it); r_rbtree_iter_next(&it)) {
+        RIntervalNode *node = r_interval_tree_iter_get(&it);
+        auto item = reinterpret_cast<RAnalMetaItem *>(node->data);
+        int bucket = bucketAt(node->start);
+        if (!item || bucket < 0) {
+            continue;
+        }
+        if (item->type == R_META_TYPE_COMMENT) {
+            leaves[bucket].comments++;
+        } else if (item->type == R_META_TYPE_STRING) {
+            leaves[bucket].strings++;
+        }
+    }
+}
+
+void DensityIndex::countComments(RCore *core, int bucket)
+{
+    BlockDescription &block = levels[0][bucket];
+    block.comments = 0;
+    RPVector *comments = r_meta_get_all_intersect(
+        core->anal, block.addr, block.size, R_META_TYPE_COMMENT);
+    if (!comments) {
+        return;
+    }
+    void **it;
+    r_pvector_foreach (comments, it) {
+        auto node = reinterpret_cast<RIntervalNode *>(*it);
+        if (node->start >= block.addr && node->start - block.addr < block.size) {
+            block.comments++;
+        }
+    }
+    r_pvector_free(comments);
+}
+
+void DensityIndex::buildLevels()
+{
+    levels.erase(levels.begin() + 1, levels.end());
+    while (levels.last().size() > 1) {
+        const QList<BlockDescription> &finer = levels.last();
+        QList<BlockDescription> coarser;
+        coarser.reserve((finer.size() + 1) / 2);
+        for (int i = 0; i < finer.size(); i += 2) {
+            BlockDescription block = finer[i];
+            if (i + 1 < finer.size()) {
+                const BlockDescription &next = finer[i + 1];
+                block.size += next.size;
+                block.flags += next.flags;
+                block.functions += next.functions;
+                block.inFunctions += next.inFunctions;
+                block.comments += next.comments;
+                block.symbols += next.symbols;
+                block.strings += next.strings;
+                block.rwx |= next.rwx;
+            }
+            coarser << block;
+        }
+        levels << coarser;
+    }
+}
+
+int DensityIndex::bucketAt(RVA addr) const
+{
+    if (addr < from || addr >= to) {
+        return -1;
+    }
+    RVA bucket = (addr - from) / step;
+    return bucket < static_cast<RVA>(levels[0].size()) ? static_cast<int>(bucket) : -1;
+}
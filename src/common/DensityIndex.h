@@ -0,0 +1,78 @@
+#ifndef DENSITYINDEX_H
+#define DENSITYINDEX_H
+
+#include "core/IaitoCommon.h"
+#include "core/IaitoDescriptions.h"
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+
+class IaitoCore;
+
+/**
+ * @brief Per bucket counts of functions, flags, symbols, strings and comments
+ * over the address range covered by the sections.
+ *
+ * The range is split in up to LEAF_COUNT buckets, and coarser levels merging
+ * pairs of buckets are kept on top of them, so statistics for any number of
+ * blocks are answered without touching the core. Each kind of item is counted
+ * again only after it changed, comments are updated per bucket.
+ */
+class IAITO_EXPORT DensityIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DensityIndex(IaitoCore *core);
+
+    /**
+     * @brief Statistics split in at least blocksCount blocks when the range
+     * is big enough, less than twice as many.
+     * @return false if there are no sections to compute the range from
+     */
+    bool statistics(unsigned int blocksCount, BlockStatistics &stats);
+
+    /**
+     * @brief Count everything again on next use
+     */
+    void invalidate();
+
+private:
+    static constexpr int LEAF_COUNT = 1 << 14;
+
+    enum Layer {
+        Bounds = 1 << 0,
+        Functions = 1 << 1,
+        Flags = 1 << 2,
+        Symbols = 1 << 3,
+        Meta = 1 << 4,
+        AllLayers = (1 << 5) - 1
+    };
+
+    QMutex mutex;
+    int dirtyLayers = AllLayers;
+    // addresses of comments changed since the last update
+    QSet<RVA> dirtyComments;
+
+    RVA from = 0;
+    RVA to = 0;
+    RVA step = 1;
+    // levels[0] has one bucket per step bytes, levels[i] merges pairs of
+    // buckets of levels[i - 1]
+    QList<QList<BlockDescription>> levels;
+
+    void markDirty(int layers);
+    void update();
+    void updateBounds(RCore *core);
+    void countFunctions(RCore *core);
+    void countFlags(RCore *core);
+    void countSymbols(RCore *core);
+    void countMeta(RCore *core);
+    void countComments(RCore *core, int bucket);
+    void buildLevels();
+    int bucketAt(RVA addr) const;
+};
+
+#endif // DENSITYINDEX_H
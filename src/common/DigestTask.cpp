@@ -0,0 +1,73 @@
+#include "DigestTask.h"
+#include "core/Iaito.h"
+
+#include <cmath>
+
+namespace {
+std::array<quint32, 256> makeCrc32Table()
+{
+    std::array<quint32, 256> table;
+    for (quint32 i = 0; i < 256; i++) {
+        quint32 c = i;
+        for (int k = 0; k < 8; k++) {
+            c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+} // namespace
+
+DigestTask::DigestTask(RVA addr, ut64 size)
+    : addr(addr)
+    , size(size)
+    , md5(QCryptographicHash::Md5)
+    , sha1(QCryptographicHash::Sha1)
+    , sha256(QCryptographicHash::Sha256)
+{}
+
+bool DigestTask::step()
+{
+    if (done >= size) {
+        return false;
+    }
+    static const std::array<quint32, 256> crc32Table = makeCrc32Table();
+
+    int len = int(qMin(CHUNK_SIZE, size - done));
+    QByteArray chunk = Core()->ioRead(addr + done, len);
+    done += len;
+
+    md5.addData(chunk);
+    sha1.addData(chunk);
+    sha256.addData(chunk);
+    for (char c : chunk) {
+        auto byte = static_cast<quint8>(c);
+        crc32 = crc32Table[(crc32 ^ byte) & 0xff] ^ (crc32 >> 8);
+        histogram[byte]++;
+    }
+    return done < size;
+}
+
+DigestTask::Result DigestTask::getResult()
+{
+    double entropy = 0;
+    for (ut64 count : histogram) {
+        if (count) {
+            double p = double(count) / size;
+            entropy -= p * std::log2(p);
+        }
+    }
+
+    Result result;
+    result.md5 = md5.result().toHex();
+    result.sha1 = sha1.result().toHex();
+    result.sha256 = sha256.result().toHex();
+    result.crc32 = QStringLiteral("%1").arg(crc32 ^ 0xffffffff, 8, 16, QLatin1Char('0'));
+    result.entropy = QString::number(entropy, 'f', 6);
+    return result;
+}
+
+void DigestTask::runTask()
+{
+    while (!isInterrupted() && step()) {}
+}
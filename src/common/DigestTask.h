@@ -0,0 +1,65 @@
+#ifndef DIGESTTASK_H
+#define DIGESTTASK_H
+
+#include "common/AsyncTask.h"
+#include "core/IaitoCommon.h"
+
+#include <QCryptographicHash>
+
+#include <array>
+
+/**
+ * @brief Computes md5, sha1, sha256, crc32 and the entropy of a memory range
+ * in a single pass.
+ *
+ * The range is read in chunks and every chunk feeds all the digests, so
+ * interrupting the task stops it after the current chunk. step() can also be
+ * called directly to compute the digests chunk by chunk on the GUI thread.
+ */
+class DigestTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    struct Result
+    {
+        QString md5;
+        QString sha1;
+        QString sha256;
+        QString crc32;
+        QString entropy;
+    };
+
+    DigestTask(RVA addr, ut64 size);
+
+    QString getTitle() override { return tr("Computing Hashes"); }
+
+    /**
+     * @brief Read and hash the next chunk
+     * @return false once the whole range is done
+     */
+    bool step();
+    /**
+     * @brief Digests of the whole range, only valid once step() returned
+     * false or the task finished without being interrupted
+     */
+    Result getResult();
+
+protected:
+    void runTask() override;
+
+private:
+    static constexpr ut64 CHUNK_SIZE = 1024 * 1024;
+
+    RVA addr;
+    ut64 size;
+    ut64 done = 0;
+
+    QCryptographicHash md5;
+    QCryptographicHash sha1;
+    QCryptographicHash sha256;
+    quint32 crc32 = 0xffffffff;
+    std::array<ut64, 256> histogram = {};
+};
+
+#endif // DIGESTTASK_H
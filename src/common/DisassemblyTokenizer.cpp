@@ -0,0 +1,240 @@
+#include "DisassemblyTokenizer.h"
+#include "common/Configuration.h"
+#include "core/Iaito.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+
+namespace {
+using Type = DisassemblyToken::Type;
+
+// When entries share a color the first one here wins, the color is the same
+// either way, only the type can be off
+const struct
+{
+    const char *name;
+    Type type;
+} TYPED_COLORS[] = {
+    {"offset", Type::Address},    {"comment", Type::Comment}, {"usercomment", Type::Comment},
+    {"flag", Type::Flag},         {"fname", Type::Flag},      {"floc", Type::Flag},
+    {"label", Type::Flag},        {"reg", Type::Register},    {"creg", Type::Register},
+    {"num", Type::Immediate},     {"mov", Type::Mnemonic},    {"jmp", Type::Mnemonic},
+    {"cjmp", Type::Mnemonic},     {"ujmp", Type::Mnemonic},   {"call", Type::Mnemonic},
+    {"ucall", Type::Mnemonic},    {"push", Type::Mnemonic},   {"pop", Type::Mnemonic},
+    {"math", Type::Mnemonic},     {"bin", Type::Mnemonic},    {"cmp", Type::Mnemonic},
+    {"ret", Type::Mnemonic},      {"nop", Type::Mnemonic},    {"trap", Type::Mnemonic},
+    {"swi", Type::Mnemonic},      {"crypto", Type::Mnemonic}, {"invalid", Type::Mnemonic},
+};
+
+/**
+ * @brief Apply the parameters of a SGR escape sequence, only the ones r2
+ * prints in 16M color mode change the colors
+ */
+void applySgr(const QChar *params, int length, QColor &color, QColor &background)
+{
+    QVector<int> list(1, 0);
+    for (int i = 0; i < length; i++) {
+        if (params[i] == QLatin1Char(';')) {
+            list.append(0);
+        } else if (params[i].isDigit()) {
+            list.last() = list.last() * 10 + params[i].digitValue();
+        }
+    }
+    for (int i = 0; i < list.size(); i++) {
+        const int code = list[i];
+        switch (code) {
+        case 0:
+            color = QColor();
+            background = QColor();
+            break;
+        case 39:
+            color = QColor();
+            break;
+        case 49:
+            background = QColor();
+            break;
+        case 38:
+        case 48:
+            if (i + 4 < list.size() && list[i + 1] == 2) {
+                QColor rgb(list[i + 2], list[i + 3], list[i + 4]);
+                (code == 38 ? color : background) = rgb;
+                i += 4;
+            } else if (i + 2 < list.size() && list[i + 1] == 5) {
+                i += 2;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+} // namespace
+
+DisassemblyTokenizer::DisassemblyTokenizer(IaitoCore *core)
+    : QObject(core)
+    , cache(CACHE_SIZE)
+{
+    connect(Config(), &Configuration::colorsUpdated, this, &DisassemblyTokenizer::invalidate);
+}
+
+DisassemblyText DisassemblyTokenizer::tokenize(const QString &ansi)
+{
+    QHash<QRgb, Role> currentRoles;
+    bool valid;
+    {
+        QMutexLocker locker(&mutex);
+        if (const DisassemblyText *text = cache.object(ansi)) {
+            return *text;
+        }
+        valid = rolesValid;
+        currentRoles = roles;
+    }
+    // Not under the mutex, the core may be locked by another thread waiting
+    // for it
+    if (!valid) {
+        currentRoles = readRoles();
+    }
+
+    DisassemblyText text = parse(ansi, currentRoles);
+
+    QMutexLocker locker(&mutex);
+    if (!valid) {
+        roles = currentRoles;
+        rolesValid = true;
+    }
+    cache.insert(ansi, new DisassemblyText(text));
+    return text;
+}
+
+void DisassemblyTokenizer::invalidate()
+{
+    QMutexLocker locker(&mutex);
+    cache.clear();
+    roles.clear();
+    rolesValid = false;
+}
+
+RichTextPainter::List DisassemblyTokenizer::richText(const DisassemblyText &text)
+{
+    RichTextPainter::List r;
+    r.reserve(text.tokens.size());
+    for (const DisassemblyToken &token : text.tokens) {
+        RichTextPainter::CustomRichText_t run;
+        run.text = text.plain.mid(token.start, token.length);
+        run.textColor = token.colorRole >= 0 ? Config()->getColor(token.colorRole) : token.color;
+        run.textBackground = token.background;
+        if (run.textColor.isValid()) {
+            run.flags = run.textBackground.isValid() ? RichTextPainter::FlagAll
+                                                     : RichTextPainter::FlagColor;
+        } else {
+            run.flags = run.textBackground.isValid() ? RichTextPainter::FlagBackground
+                                                     : RichTextPainter::FlagNone;
+        }
+        r.push_back(run);
+    }
+    return r;
+}
+
+QString DisassemblyTokenizer::html(const DisassemblyText &text)
+{
+    QString r;
+    for (const DisassemblyToken &token : text.tokens) {
+        const QColor color = token.colorRole >= 0 ? Config()->getColor(token.colorRole)
+                                                  : token.color;
+        QStringList style;
+        if (color.isValid()) {
+            style << QStringLiteral("color:%1").arg(color.name());
+        }
+        if (token.background.isValid()) {
+            style << QStringLiteral("background-color:%1").arg(token.background.name());
+        }
+        QString escaped = text.plain.mid(token.start, token.length).toHtmlEscaped();
+        escaped.replace(QLatin1Char(' '), QStringLiteral("&nbsp;"));
+        if (style.isEmpty()) {
+            r += escaped;
+        } else {
+            r += QStringLiteral("<span style=\"%1\">%2</span>")
+                     .arg(style.join(QLatin1Char(';')), escaped);
+        }
+    }
+    return r;
+}
+
+QHash<QRgb, DisassemblyTokenizer::Role> DisassemblyTokenizer::readRoles()
+{
+    const QJsonObject palette = Core()->cmdj("ecj").object();
+    QHash<QRgb, Role> r;
+    auto add = [&r](const QJsonValue &value, const QString &name, Type type) {
+        const QJsonArray rgb = value.toArray();
+        if (rgb.size() < 3) {
+            return;
+        }
+        const QRgb key = qRgb(rgb[0].toInt(), rgb[1].toInt(), rgb[2].toInt());
+        if (!r.contains(key)) {
+            r.insert(key, {Configuration::colorId(name), type});
+        }
+    };
+    for (const auto &typed : TYPED_COLORS) {
+        const QString name = QString::fromLatin1(typed.name);
+        add(palette.value(name), name, typed.type);
+    }
+    for (auto it = palette.constBegin(); it != palette.constEnd(); ++it) {
+        add(it.value(), it.key(), Type::Text);
+    }
+    return r;
+}
+
+DisassemblyText DisassemblyTokenizer::parse(const QString &ansi, const QHash<QRgb, Role> &roles)
+{
+    DisassemblyText r;
+    r.plain.reserve(ansi.size());
+    QColor color;
+    QColor background;
+    bool styleChanged = true;
+
+    const int size = ansi.size();
+    int i = 0;
+    while (i < size) {
+        const QChar c = ansi[i];
+        if (c == QLatin1Char('\x1b') && i + 1 < size && ansi[i + 1] == QLatin1Char('[')) {
+            // CSI sequence, ends with a character in @ to ~
+            int end = i + 2;
+            while (end < size && (ansi[end].unicode() < 0x40 || ansi[end].unicode() > 0x7e)) {
+                end++;
+            }
+            if (end < size && ansi[end] == QLatin1Char('m')) {
+                const QColor oldColor = color;
+                const QColor oldBackground = background;
+                applySgr(ansi.constData() + i + 2, end - i - 2, color, background);
+                styleChanged = styleChanged || color != oldColor || background != oldBackground;
+            }
+            i = end + 1;
+            continue;
+        }
+        if (c == QLatin1Char('\r') || c == QLatin1Char('\n')) {
+            i++;
+            continue;
+        }
+        if (styleChanged || r.tokens.isEmpty()) {
+            DisassemblyToken token;
+            token.start = r.plain.size();
+            token.length = 0;
+            if (color.isValid()) {
+                auto role = roles.constFind(color.rgb());
+                if (role != roles.constEnd()) {
+                    token.colorRole = role->colorRole;
+                    token.type = role->type;
+                } else {
+                    token.color = color;
+                }
+            }
+            token.background = background;
+            r.tokens.append(token);
+            styleChanged = false;
+        }
+        r.plain.append(c == QChar::Nbsp ? QLatin1Char(' ') : c);
+        r.tokens.last().length++;
+        i++;
+    }
+    return r;
+}
@@ -0,0 +1,71 @@
+#ifndef DISASSEMBLYTOKENIZER_H
+#define DISASSEMBLYTOKENIZER_H
+
+#include "common/RichTextPainter.h"
+#include "core/IaitoCommon.h"
+#include "core/IaitoDescriptions.h"
+
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+
+class IaitoCore;
+
+/**
+ * @brief Splits colored r2 output into DisassemblyText tokens.
+ *
+ * r2 decides what a piece of a line is when it picks its color from the
+ * palette, so tokens are typed by mapping the colors back to the palette
+ * entries. The escape sequences are parsed in a single pass, without going
+ * through HTML and a QTextDocument, and lines are cached by their colored
+ * text, so the disassembly, the graph and the previews share the work when
+ * they show the same lines.
+ *
+ * Tokens keep the palette entry rather than the color, the renderers resolve
+ * it with Config()->getColor() when they convert the tokens. The disassembly
+ * uses the types to highlight a word only where it has the same meaning.
+ */
+class IAITO_EXPORT DisassemblyTokenizer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DisassemblyTokenizer(IaitoCore *core);
+
+    /**
+     * @param ansi line printed with scr.color=3
+     */
+    DisassemblyText tokenize(const QString &ansi);
+
+    /**
+     * @brief Forget the cached lines and read the palette again on next use
+     */
+    void invalidate();
+
+    static RichTextPainter::List richText(const DisassemblyText &text);
+    /**
+     * @return text as HTML, with non breaking spaces
+     */
+    static QString html(const DisassemblyText &text);
+
+private:
+    // lines, about 16 screens of disassembly
+    static constexpr int CACHE_SIZE = 2048;
+
+    struct Role
+    {
+        int colorRole;
+        DisassemblyToken::Type type;
+    };
+
+    QMutex mutex;
+    QCache<QString, DisassemblyText> cache;
+    QHash<QRgb, Role> roles;
+    bool rolesValid = false;
+
+    static QHash<QRgb, Role> readRoles();
+    static DisassemblyText parse(const QString &ansi, const QHash<QRgb, Role> &roles);
+};
+
+#endif // DISASSEMBLYTOKENIZER_H
@@ -0,0 +1,18 @@
+#include "GraphLayoutTask.h"
+
+GraphLayoutTask::GraphLayoutTask(
+    std::unique_ptr<GraphLayout> layout, GraphLayout::Graph graph, ut64 entry)
+    : layout(std::move(layout))
+    , graph(std::move(graph))
+    , entry(entry)
+{}
+
+void GraphLayoutTask::runTask()
+{
+    log(tr("Laying out %n blocks...", "", int(graph.size())));
+    layout->setInterruptCheck([this]() { return isInterrupted(); });
+    layout->CalculateLayout(graph, entry, width, height);
+    if (isInterrupted()) {
+        log(tr("Canceled"));
+    }
+}
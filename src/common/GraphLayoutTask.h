@@ -0,0 +1,39 @@
+#ifndef GRAPHLAYOUTTASK_H
+#define GRAPHLAYOUTTASK_H
+
+#include "common/AsyncTask.h"
+#include "widgets/GraphLayout.h"
+
+#include <memory>
+
+/**
+ * @brief Computes a graph layout away from the GUI thread.
+ * Works on its own copy of both the graph and the layout settings, so the
+ * view can keep changing while the task runs. The result is only valid if the
+ * task was not interrupted.
+ */
+class GraphLayoutTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    GraphLayoutTask(std::unique_ptr<GraphLayout> layout, GraphLayout::Graph graph, ut64 entry);
+
+    QString getTitle() override { return tr("Computing Graph Layout"); }
+
+    GraphLayout::Graph &getGraph() { return graph; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+protected:
+    void runTask() override;
+
+private:
+    std::unique_ptr<GraphLayout> layout;
+    GraphLayout::Graph graph;
+    ut64 entry;
+    int width = 0;
+    int height = 0;
+};
+
+#endif // GRAPHLAYOUTTASK_H
@@ -1,4 +1,5 @@
 #include "IOModesController.h"
+#include "DecompilerCache.h"
 #include "Iaito.h"
 
 #include <QJsonArray>
@@ -109,6 +110,8 @@ bool IOModesController::askCommitUnsavedChanges()
             Core()->commitWriteCache();
         } else if (ret == QMessageBox::Discard) {
             Core()->cmdRaw("wcr");
+            // The reverted bytes may be in functions decompiled since
+            Core()->getDecompilerCache()->invalidate();
             emit Core() -> refreshCodeViews();
         } else if (ret == QMessageBox::Cancel) {
             return false;
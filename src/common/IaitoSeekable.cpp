@@ -67,7 +67,7 @@ void IaitoSeekable::seekToReference(RVA offset)
     }
 
     RVA target;
-    QList<XrefDescription> refs = Core()->getXRefs(offset, false, false);
+    QList<XrefDescription> refs = Core()->getXRefs(offset, false, false, QString(), false);
 
     if (refs.length()) {
         if (refs.length() > 1) {
@@ -0,0 +1,284 @@
+#include "InstructionIndex.h"
+#include "core/Iaito.h"
+
+#include <algorithm>
+
+namespace {
+/**
+ * Range the sweep takes as is instead of decoding it: an analyzed basic block
+ * or a sized metadata item
+ */
+struct SweepItem
+{
+    RVA addr;
+    RVA size;
+    // instruction offsets from addr, empty for a metadata item
+    QVector<ut64> insns;
+};
+
+bool isSizedMeta(RAnalMetaType type)
+{
+    switch (type) {
+    case R_META_TYPE_DATA:
+    case R_META_TYPE_STRING:
+    case R_META_TYPE_FORMAT:
+    case R_META_TYPE_MAGIC:
+    case R_META_TYPE_HIDE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool appendBlock(RAnalBlock *bb, void *user)
+{
+    SweepItem item{bb->addr, bb->size, {}};
+    for (int i = 0; i < bb->ninstr; i++) {
+        ut64 offset = r_anal_bb_offset_inst(bb, i);
+        if (offset >= bb->size) {
+            break;
+        }
+        item.insns.append(offset);
+    }
+    static_cast<QVector<SweepItem> *>(user)->append(item);
+    return true;
+}
+
+QVector<SweepItem> sweepItems(RCore *core, RVA addr, RVA size)
+{
+    QVector<SweepItem> items;
+    RPVector *metas = r_meta_get_all_intersect(core->anal, addr, size, R_META_TYPE_ANY);
+    if (metas) {
+        void **it;
+        r_pvector_foreach (metas, it) {
+            auto node = reinterpret_cast<RIntervalNode *>(*it);
+            auto item = reinterpret_cast<RAnalMetaItem *>(node->data);
+            if (item && isSizedMeta(item->type)) {
+                items.append({node->start, node->end - node->start + 1, {}});
+            }
+        }
+        r_pvector_free(metas);
+    }
+    r_anal_blocks_foreach_intersect(core->anal, addr, size, appendBlock, &items);
+    // Metadata was added first, so it wins over a block at the same address
+    // like in the disassembly
+    std::stable_sort(items.begin(), items.end(), [](const SweepItem &a, const SweepItem &b) {
+        return a.addr < b.addr;
+    });
+    return items;
+}
+} // namespace
+
+InstructionIndex::InstructionIndex(IaitoCore *core)
+    : QObject(core)
+    , chunks(MAX_CHUNKS)
+{
+    auto invalidateAll = [this]() { invalidate(); };
+    connect(core, &IaitoCore::refreshAll, this, invalidateAll);
+    connect(core, &IaitoCore::refreshCodeViews, this, invalidateAll);
+    connect(core, &IaitoCore::functionsChanged, this, invalidateAll);
+    connect(core, &IaitoCore::codeRebased, this, invalidateAll);
+    connect(core, &IaitoCore::asmOptionsChanged, this, invalidateAll);
+    connect(core, &IaitoCore::switchedProcess, this, invalidateAll);
+    connect(core, &IaitoCore::ioCacheChanged, this, invalidateAll);
+    connect(core, &IaitoCore::writeModeChanged, this, invalidateAll);
+    connect(core, &IaitoCore::ioModeChanged, this, invalidateAll);
+    connect(core, &IaitoCore::instructionChanged, this, [this](RVA offset) {
+        invalidate(offset);
+    });
+}
+
+RVA InstructionIndex::next(RVA addr, int count)
+{
+    if (count <= 0) {
+        return addr;
+    }
+    RCoreLocked core(Core());
+    QMutexLocker locker(&mutex);
+    checkDecoderConfig(core);
+
+    const RVA first = chunkBase(addr);
+    for (RVA base = first;; base += CHUNK_SIZE) {
+        const Chunk *c = chunk(core, base);
+        auto it = c->starts.cbegin();
+        if (base == first) {
+            it = std::upper_bound(c->starts.cbegin(), c->starts.cend(), quint16(addr - base));
+        }
+        int available = int(c->starts.cend() - it);
+        if (available >= count) {
+            return base + it[count - 1];
+        }
+        count -= available;
+        if (base == chunkBase(RVA_MAX)) {
+            return RVA_MAX;
+        }
+    }
+}
+
+RVA InstructionIndex::prev(RVA addr, int count)
+{
+    if (count <= 0) {
+        return addr;
+    }
+    RCoreLocked core(Core());
+    QMutexLocker locker(&mutex);
+    checkDecoderConfig(core);
+
+    const RVA first = chunkBase(addr);
+    for (RVA base = first;; base -= CHUNK_SIZE) {
+        const Chunk *c = chunk(core, base);
+        auto it = c->starts.cend();
+        if (base == first) {
+            it = std::lower_bound(c->starts.cbegin(), c->starts.cend(), quint16(addr - base));
+        }
+        int available = int(it - c->starts.cbegin());
+        if (available >= count) {
+            return base + *(it - count);
+        }
+        count -= available;
+        if (!base) {
+            return 0;
+        }
+    }
+}
+
+void InstructionIndex::invalidate()
+{
+    QMutexLocker locker(&mutex);
+    chunks.clear();
+}
+
+void InstructionIndex::invalidate(RVA addr)
+{
+    QMutexLocker locker(&mutex);
+    // An instruction starting in the previous chunk may cover addr, and the
+    // next chunk starts where this one ends
+    RVA from = chunkBase(addr > RVA(MAX_OP_SIZE) ? addr - MAX_OP_SIZE : 0);
+    RVA to = chunkBase(addr);
+    for (RVA base = from; base <= to; base += CHUNK_SIZE) {
+        chunks.remove(base);
+    }
+    if (to != chunkBase(RVA_MAX)) {
+        chunks.remove(to + CHUNK_SIZE);
+    }
+}
+
+void InstructionIndex::checkDecoderConfig(RCore *core)
+{
+    QByteArray config = QByteArray(r_config_get(core->config, "asm.arch")) + ' '
+                        + QByteArray::number(r_config_get_i(core->config, "asm.bits")) + ' '
+                        + QByteArray(r_config_get(core->config, "asm.cpu"));
+    if (config != decoderConfig) {
+        chunks.clear();
+        decoderConfig = config;
+    }
+}
+
+const InstructionIndex::Chunk *InstructionIndex::chunk(RCore *core, RVA base)
+{
+    if (const Chunk *c = chunks.object(base)) {
+        return c;
+    }
+    RVA entry = base;
+    if (base) {
+        if (const Chunk *before = chunks.object(base - CHUNK_SIZE)) {
+            entry = qMax(before->carry, base);
+        }
+    }
+    Chunk *c = buildChunk(core, base, entry);
+    if (base != chunkBase(RVA_MAX)) {
+        // The next chunk was swept from a different address, sweep it again
+        // once needed so both agree on the border
+        const Chunk *after = chunks.object(base + CHUNK_SIZE);
+        if (after && after->entry != c->carry) {
+            chunks.remove(base + CHUNK_SIZE);
+        }
+    }
+    chunks.insert(base, c);
+    return c;
+}
+
+InstructionIndex::Chunk *InstructionIndex::buildChunk(RCore *core, RVA base, RVA entry)
+{
+    auto c = new Chunk;
+    c->entry = entry;
+    c->carry = entry;
+    const RVA last = base + (CHUNK_SIZE - 1);
+    if (entry > last) {
+        // swallowed by an item of the previous chunk
+        return c;
+    }
+
+    QByteArray buf(int(last - entry + 1) + MAX_OP_SIZE, '\xff');
+    Core()->ioReadAt(core, entry, reinterpret_cast<ut8 *>(buf.data()), buf.size());
+    const QVector<SweepItem> items = sweepItems(core, entry, last - entry + 1);
+    const int minOpSize = qMax(1, r_anal_archinfo(core->anal, R_ANAL_ARCHINFO_MIN_OP_SIZE));
+
+    RVA p = entry;
+    // first instruction past the chunk of a block crossing its end
+    RVA crossing = RVA_INVALID;
+    auto appendInsns = [&](const SweepItem &item, RVA from) {
+        for (ut64 offset : item.insns) {
+            if (offset < from - item.addr) {
+                continue;
+            }
+            if (offset > last - item.addr) {
+                crossing = item.addr + offset;
+                break;
+            }
+            c->starts.append(quint16(item.addr + offset - base));
+        }
+    };
+    // An item started before the chunk and covers its entry, the previous
+    // chunk stopped at its instructions on the border or isn't known
+    for (const SweepItem &item : items) {
+        if (item.addr < entry && entry - item.addr < item.size) {
+            appendInsns(item, entry);
+            p = item.size > RVA_MAX - item.addr ? RVA_MAX : item.addr + item.size;
+            break;
+        }
+    }
+
+    int i = 0;
+    while (p <= last) {
+        while (i < items.size() && items[i].addr < p) {
+            i++;
+        }
+        RVA size;
+        if (i < items.size() && items[i].addr == p) {
+            const SweepItem &item = items[i++];
+            if (item.insns.isEmpty()) {
+                c->starts.append(quint16(p - base));
+            }
+            appendInsns(item, p);
+            size = qMax<RVA>(item.size, 1);
+        } else {
+            int at = int(p - entry);
+            RAnalOp op;
+            r_anal_op_init(&op);
+            int opSize = r_anal_op(
+                core->anal,
+                &op,
+                p,
+                reinterpret_cast<const ut8 *>(buf.constData()) + at,
+                buf.size() - at,
+                R_ANAL_OP_MASK_BASIC);
+            r_anal_op_fini(&op);
+            size = opSize > 0 ? opSize : minOpSize;
+            // Resynchronize on the next block or metadata item
+            if (i < items.size() && size > items[i].addr - p) {
+                size = items[i].addr - p;
+            }
+            c->starts.append(quint16(p - base));
+        }
+        if (size > RVA_MAX - p) {
+            p = RVA_MAX;
+            break;
+        }
+        p += size;
+    }
+    // Continue on the instructions of a crossing block rather than after it,
+    // the next chunk lists them from there
+    c->carry = crossing != RVA_INVALID ? crossing : p;
+    return c;
+}
@@ -0,0 +1,81 @@
+#ifndef INSTRUCTIONINDEX_H
+#define INSTRUCTIONINDEX_H
+
+#include "core/IaitoCommon.h"
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+
+class IaitoCore;
+
+/**
+ * @brief Instruction boundaries of the address space, for moving by a number
+ * of instructions without disassembling.
+ *
+ * The address space is split in chunks that are swept lazily the first time
+ * they are needed. Basic blocks from the analysis and sized metadata (data,
+ * strings, formats...) are used as they are, the decoder only fills the gaps
+ * between them, so boundaries match what the disassembly shows. A chunk
+ * sweep continues from where the previous chunk ended when it is known, so
+ * instructions crossing a chunk border are handled.
+ */
+class IAITO_EXPORT InstructionIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InstructionIndex(IaitoCore *core);
+
+    /**
+     * @return address of the count-th instruction after addr, or RVA_MAX if
+     * the end of the address space is reached
+     */
+    RVA next(RVA addr, int count);
+    /**
+     * @return address of the count-th instruction before addr, or 0 if the
+     * start of the address space is reached
+     */
+    RVA prev(RVA addr, int count);
+
+    /**
+     * @brief Drop every chunk
+     */
+    void invalidate();
+    /**
+     * @brief Drop the chunks whose boundaries may depend on the bytes at addr
+     */
+    void invalidate(RVA addr);
+
+private:
+    static constexpr RVA CHUNK_SIZE = 0x10000;
+    // about 16 MiB of code
+    static constexpr int MAX_CHUNKS = 256;
+    // bytes read past the end of a chunk for the last instruction
+    static constexpr int MAX_OP_SIZE = 32;
+
+    struct Chunk
+    {
+        // address the sweep started from, may be after the chunk start
+        RVA entry;
+        // where the next chunk continues, the address following the last
+        // instruction or the first one past the border of a crossing block
+        RVA carry;
+        // instruction starts, relative to the chunk start
+        QVector<quint16> starts;
+    };
+
+    QMutex mutex;
+    QCache<RVA, Chunk> chunks;
+    // asm.arch, asm.bits and asm.cpu the chunks were built with
+    QByteArray decoderConfig;
+
+    static RVA chunkBase(RVA addr) { return addr & ~(CHUNK_SIZE - 1); }
+    void checkDecoderConfig(RCore *core);
+    const Chunk *chunk(RCore *core, RVA base);
+    Chunk *buildChunk(RCore *core, RVA base, RVA entry);
+};
+
+#endif // INSTRUCTIONINDEX_H
@@ -0,0 +1,182 @@
+#include "MemoryPageCache.h"
+#include "core/Iaito.h"
+
+#include <algorithm>
+
+/**
+ * @brief Reads the queued prefetch pages on a worker thread
+ */
+class MemoryPrefetchTask : public AsyncTask
+{
+public:
+    explicit MemoryPrefetchTask(MemoryPageCache *cache)
+        : cache(cache)
+    {}
+
+protected:
+    void runTask() override
+    {
+        uint64_t addr;
+        quint64 pageGeneration;
+        while (!isInterrupted() && cache->takePrefetchAddress(addr, pageGeneration)) {
+            cache->insertPage(
+                addr, Core()->ioRead(addr, MemoryPageCache::PAGE_SIZE), pageGeneration);
+        }
+    }
+
+private:
+    MemoryPageCache *cache;
+};
+
+MemoryPageCache::MemoryPageCache(IaitoCore *core)
+    : QObject(core)
+    , pages(MAX_PAGES)
+{
+    prefetchTimer.setInterval(0);
+    connect(&prefetchTimer, &QTimer::timeout, this, &MemoryPageCache::prefetchStep);
+
+    // Anything that may have changed memory without telling where
+    auto invalidateAll = [this]() { invalidate(); };
+    connect(core, &IaitoCore::refreshAll, this, invalidateAll);
+    connect(core, &IaitoCore::refreshCodeViews, this, invalidateAll);
+    connect(core, &IaitoCore::registersChanged, this, invalidateAll);
+    connect(core, &IaitoCore::stackChanged, this, invalidateAll);
+    connect(core, &IaitoCore::codeRebased, this, invalidateAll);
+    connect(core, &IaitoCore::switchedThread, this, invalidateAll);
+    connect(core, &IaitoCore::switchedProcess, this, invalidateAll);
+    connect(core, &IaitoCore::debugTaskStateChanged, this, invalidateAll);
+    connect(core, &IaitoCore::ioCacheChanged, this, invalidateAll);
+    connect(core, &IaitoCore::writeModeChanged, this, invalidateAll);
+    connect(core, &IaitoCore::ioModeChanged, this, invalidateAll);
+    // Instruction edits (wa, wao...) write a few bytes from offset on, which
+    // may run into the next page. Longer byte edits drop their own range.
+    connect(core, &IaitoCore::instructionChanged, this, [this](RVA offset) {
+        invalidate(offset, PAGE_SIZE);
+    });
+}
+
+MemoryPageCache::~MemoryPageCache()
+{
+    if (prefetchTask) {
+        prefetchTask->interrupt();
+        prefetchTask->wait();
+    }
+}
+
+QByteArray MemoryPageCache::page(uint64_t addr)
+{
+    quint64 pageGeneration;
+    {
+        QMutexLocker locker(&mutex);
+        if (QByteArray *cached = pages.object(addr)) {
+            return *cached;
+        }
+        pageGeneration = generation;
+    }
+    QByteArray data = Core()->ioRead(addr, PAGE_SIZE);
+    insertPage(addr, data, pageGeneration);
+    return data;
+}
+
+void MemoryPageCache::prefetch(uint64_t addr, uint64_t len, uint64_t center)
+{
+    if (!len) {
+        return;
+    }
+    uint64_t first = addr & ~(PAGE_SIZE - 1);
+    uint64_t last = (len - 1 > UINT64_MAX - addr ? UINT64_MAX : addr + len - 1)
+                    & ~(PAGE_SIZE - 1);
+    center &= ~(PAGE_SIZE - 1);
+    center = qBound(first, center, last);
+
+    // Alternate below and above center, queue is consumed from the back so
+    // build it farthest first
+    QVector<uint64_t> order;
+    uint64_t below = center;
+    uint64_t above = center;
+    order.append(center);
+    while (below > first || above < last) {
+        if (above < last) {
+            above += PAGE_SIZE;
+            order.append(above);
+        }
+        if (below > first) {
+            below -= PAGE_SIZE;
+            order.append(below);
+        }
+    }
+    std::reverse(order.begin(), order.end());
+
+    QMutexLocker locker(&mutex);
+    prefetchQueue = order;
+    if (prefetchRunning) {
+        return;
+    }
+    prefetchRunning = true;
+#if MONOTHREAD
+    prefetchTimer.start();
+#else
+    prefetchTask.reset(new MemoryPrefetchTask(this));
+    Core()->getAsyncTaskManager()->start(prefetchTask);
+#endif
+}
+
+void MemoryPageCache::invalidate()
+{
+    QMutexLocker locker(&mutex);
+    generation++;
+    pages.clear();
+}
+
+void MemoryPageCache::invalidate(uint64_t addr, uint64_t len)
+{
+    if (!len) {
+        return;
+    }
+    QMutexLocker locker(&mutex);
+    generation++;
+    if (len / PAGE_SIZE >= uint64_t(MAX_PAGES)) {
+        pages.clear();
+        return;
+    }
+    uint64_t last = len - 1 > UINT64_MAX - addr ? UINT64_MAX : addr + len - 1;
+    for (uint64_t p = addr & ~(PAGE_SIZE - 1); p <= last; p += PAGE_SIZE) {
+        pages.remove(p);
+        if (p > UINT64_MAX - PAGE_SIZE) {
+            break;
+        }
+    }
+}
+
+bool MemoryPageCache::takePrefetchAddress(uint64_t &addr, quint64 &pageGeneration)
+{
+    QMutexLocker locker(&mutex);
+    while (!prefetchQueue.isEmpty()) {
+        addr = prefetchQueue.takeLast();
+        if (!pages.contains(addr)) {
+            pageGeneration = generation;
+            return true;
+        }
+    }
+    prefetchRunning = false;
+    return false;
+}
+
+void MemoryPageCache::insertPage(uint64_t addr, const QByteArray &data, quint64 pageGeneration)
+{
+    QMutexLocker locker(&mutex);
+    if (pageGeneration == generation) {
+        pages.insert(addr, new QByteArray(data));
+    }
+}
+
+void MemoryPageCache::prefetchStep()
+{
+    uint64_t addr;
+    quint64 pageGeneration;
+    if (!takePrefetchAddress(addr, pageGeneration)) {
+        prefetchTimer.stop();
+        return;
+    }
+    insertPage(addr, Core()->ioRead(addr, PAGE_SIZE), pageGeneration);
+}
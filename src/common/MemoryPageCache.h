@@ -0,0 +1,77 @@
+#ifndef MEMORYPAGECACHE_H
+#define MEMORYPAGECACHE_H
+
+#include "common/AsyncTask.h"
+#include "core/IaitoCommon.h"
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+class IaitoCore;
+
+/**
+ * @brief LRU cache of io pages shared by the views reading raw memory.
+ *
+ * Pages are keyed by their aligned address and kept until the memory may have
+ * changed: writes, io cache mode changes, debugger steps or a global refresh.
+ * Pages around what is displayed can be read ahead of time so scrolling
+ * doesn't have to wait for the core.
+ */
+class IAITO_EXPORT MemoryPageCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr uint64_t PAGE_SIZE = 0x1000;
+
+    explicit MemoryPageCache(IaitoCore *core);
+    ~MemoryPageCache() override;
+
+    /**
+     * @brief Get the page starting at addr, reading it if it isn't cached
+     * @param addr - page aligned address
+     */
+    QByteArray page(uint64_t addr);
+
+    /**
+     * @brief Read pages overlapping [addr, addr + len) in the background,
+     * nearest to center first. Replaces any prefetch still pending.
+     */
+    void prefetch(uint64_t addr, uint64_t len, uint64_t center);
+
+    /**
+     * @brief Drop every cached page
+     */
+    void invalidate();
+    /**
+     * @brief Drop the cached pages overlapping [addr, addr + len)
+     */
+    void invalidate(uint64_t addr, uint64_t len);
+
+private:
+    // about 16 MiB of pages
+    static constexpr int MAX_PAGES = 4096;
+
+    QMutex mutex;
+    QCache<uint64_t, QByteArray> pages;
+    // pending prefetch addresses, last one is read first
+    QVector<uint64_t> prefetchQueue;
+    // incremented by invalidations, pages read before are not inserted
+    quint64 generation = 0;
+    bool prefetchRunning = false;
+    // used when the core can't be read from other threads (MONOTHREAD)
+    QTimer prefetchTimer;
+    AsyncTask::Ptr prefetchTask;
+
+    bool takePrefetchAddress(uint64_t &addr, quint64 &pageGeneration);
+    void insertPage(uint64_t addr, const QByteArray &data, quint64 pageGeneration);
+    void prefetchStep();
+
+    friend class MemoryPrefetchTask;
+};
+
+#endif // MEMORYPAGECACHE_H
@@ -8,6 +8,94 @@
 
 #include <QFile>
 
+#include <cstring>
+
+static PyTypeObject *functionType = nullptr;
+static PyTypeObject *basicBlockType = nullptr;
+static PyTypeObject *xrefType = nullptr;
+static PyTypeObject *flagType = nullptr;
+static PyTypeObject *stringType = nullptr;
+
+// Largest read(), the length is passed to r2 as an int
+static const Py_ssize_t MAX_READ_SIZE = 256 * 1024 * 1024;
+
+static PyStructSequence_Field functionFields[]
+    = {{"offset", NULL},
+       {"name", NULL},
+       {"size", "linear size"},
+       {"realsize", "sum of the basic block sizes"},
+       {"nbbs", NULL},
+       {"nargs", NULL},
+       {"nlocals", NULL},
+       {"calltype", NULL},
+       {"edges", NULL},
+       {"stackframe", NULL},
+       {NULL, NULL}};
+static PyStructSequence_Desc functionDesc
+    = {"_cutter.Function", "Analyzed function", functionFields, 10};
+
+static PyStructSequence_Field basicBlockFields[]
+    = {{"addr", NULL},
+       {"size", NULL},
+       {"jump", "UT64_MAX if none"},
+       {"fail", "UT64_MAX if none"},
+       {"ninstr", NULL},
+       {NULL, NULL}};
+static PyStructSequence_Desc basicBlockDesc
+    = {"_cutter.BasicBlock", "Basic block of a function", basicBlockFields, 5};
+
+static PyStructSequence_Field xrefFields[]
+    = {{"from_addr", NULL}, {"to_addr", NULL}, {"type", NULL}, {"from_str", NULL}, {NULL, NULL}};
+static PyStructSequence_Desc xrefDesc = {"_cutter.Xref", "Cross reference", xrefFields, 4};
+
+static PyStructSequence_Field flagFields[]
+    = {{"offset", NULL}, {"size", NULL}, {"name", NULL}, {"realname", NULL}, {NULL, NULL}};
+static PyStructSequence_Desc flagDesc = {"_cutter.Flag", "Flag", flagFields, 4};
+
+static PyStructSequence_Field stringFields[]
+    = {{"vaddr", NULL},
+       {"string", NULL},
+       {"type", NULL},
+       {"section", NULL},
+       {"length", NULL},
+       {"size", NULL},
+       {NULL, NULL}};
+static PyStructSequence_Desc stringDesc
+    = {"_cutter.String", "String in the binary", stringFields, 6};
+
+static PyObject *toPython(const QString &str)
+{
+    const QByteArray utf8 = str.toUtf8();
+    return PyUnicode_FromStringAndSize(utf8.constData(), utf8.size());
+}
+
+static PyObject *toPython(ut64 value)
+{
+    return PyLong_FromUnsignedLongLong(value);
+}
+
+/**
+ * @brief Build a list of type items, fill sets the fields of each one
+ */
+template<typename T, typename Fill>
+static PyObject *toList(const QList<T> &items, PyTypeObject *type, Fill fill)
+{
+    PyObject *list = PyList_New(items.size());
+    if (!list) {
+        return NULL;
+    }
+    for (int i = 0; i < items.size(); i++) {
+        PyObject *item = PyStructSequence_New(type);
+        if (!item) {
+            Py_DECREF(list);
+            return NULL;
+        }
+        fill(item, items.at(i));
+        PyList_SetItem(list, i, item);
+    }
+    return list;
+}
+
 PyObject *api_version(PyObject *self, PyObject *null)
 {
     Q_UNUSED(self)
@@ -30,6 +118,219 @@ PyObject *api_cmd(PyObject *self, PyObject *args)
     return PyUnicode_FromString(result);
 }
 
+PyObject *api_cmds(PyObject *self, PyObject *args)
+{
+    Q_UNUSED(self);
+    PyObject *commands;
+    if (!PyArg_ParseTuple(args, "O:commands", &commands)) {
+        return NULL;
+    }
+    PyObject *iter = PyObject_GetIter(commands);
+    if (!iter) {
+        return NULL;
+    }
+
+    // The iterator runs Python code, which may call back into the API from
+    // another thread, so it is drained before the core is taken
+    QList<QByteArray> batch;
+    PyObject *command;
+    while ((command = PyIter_Next(iter))) {
+        PyObject *utf8 = PyUnicode_AsUTF8String(command);
+        Py_DECREF(command);
+        if (!utf8) {
+            Py_DECREF(iter);
+            return NULL;
+        }
+        batch << QByteArray(PyBytes_AsString(utf8));
+        Py_DECREF(utf8);
+    }
+    Py_DECREF(iter);
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+
+    QStringList outputs;
+    {
+        // Hold the core for the whole batch so no other command runs in
+        // between
+        RCoreLocked core = Core()->core();
+        for (const QByteArray &cmd : std::as_const(batch)) {
+            outputs << Core()->cmd(cmd.constData());
+        }
+    }
+
+    PyObject *results = PyList_New(outputs.size());
+    if (!results) {
+        return NULL;
+    }
+    for (int i = 0; i < outputs.size(); i++) {
+        PyObject *result = toPython(outputs.at(i));
+        if (!result) {
+            Py_DECREF(results);
+            return NULL;
+        }
+        PyList_SetItem(results, i, result);
+    }
+    return results;
+}
+
+PyObject *api_functions(PyObject *self, PyObject *null)
+{
+    Q_UNUSED(self)
+    Q_UNUSED(null)
+    return toList(
+        Core()->getAllFunctions(),
+        functionType,
+        [](PyObject *item, const FunctionDescription &function) {
+            PyStructSequence_SetItem(item, 0, toPython(function.offset));
+            PyStructSequence_SetItem(item, 1, toPython(function.name));
+            PyStructSequence_SetItem(item, 2, toPython(function.linearSize));
+            PyStructSequence_SetItem(item, 3, toPython(function.realSize));
+            PyStructSequence_SetItem(item, 4, toPython(function.nbbs));
+            PyStructSequence_SetItem(item, 5, toPython(function.nargs));
+            PyStructSequence_SetItem(item, 6, toPython(function.nlocals));
+            PyStructSequence_SetItem(item, 7, toPython(function.calltype));
+            PyStructSequence_SetItem(item, 8, toPython(function.edges));
+            PyStructSequence_SetItem(item, 9, toPython(function.stackframe));
+        });
+}
+
+PyObject *api_basic_blocks(PyObject *self, PyObject *args)
+{
+    Q_UNUSED(self);
+    unsigned long long addr;
+    if (!PyArg_ParseTuple(args, "K:addr", &addr)) {
+        return NULL;
+    }
+
+    struct BasicBlock
+    {
+        RVA addr;
+        RVA size;
+        RVA jump;
+        RVA fail;
+        ut64 ninstr;
+    };
+    QList<BasicBlock> blocks;
+    {
+        RCoreReadLocked core = Core()->coreRead();
+        RAnalFunction *fcn = r_anal_get_fcn_in(core->anal, addr, 0);
+        if (fcn) {
+            RListIter *iter;
+            RAnalBlock *bb;
+            IaitoRListForeach(fcn->bbs, iter, RAnalBlock, bb)
+            {
+                blocks.append({bb->addr, bb->size, bb->jump, bb->fail, ut64(bb->ninstr)});
+            }
+        }
+    }
+    return toList(blocks, basicBlockType, [](PyObject *item, const BasicBlock &block) {
+        PyStructSequence_SetItem(item, 0, toPython(block.addr));
+        PyStructSequence_SetItem(item, 1, toPython(block.size));
+        PyStructSequence_SetItem(item, 2, toPython(block.jump));
+        PyStructSequence_SetItem(item, 3, toPython(block.fail));
+        PyStructSequence_SetItem(item, 4, toPython(block.ninstr));
+    });
+}
+
+static PyObject *xrefs(PyObject *args, bool to)
+{
+    unsigned long long addr;
+    if (!PyArg_ParseTuple(args, "K:addr", &addr)) {
+        return NULL;
+    }
+    return toList(
+        Core()->getXRefs(addr, to, false, QString(), false),
+        xrefType,
+        [](PyObject *item, const XrefDescription &xref) {
+            PyStructSequence_SetItem(item, 0, toPython(xref.from));
+            PyStructSequence_SetItem(item, 1, toPython(xref.to));
+            PyStructSequence_SetItem(item, 2, toPython(xref.type));
+            PyStructSequence_SetItem(item, 3, toPython(xref.from_str));
+        });
+}
+
+PyObject *api_xrefs_to(PyObject *self, PyObject *args)
+{
+    Q_UNUSED(self);
+    return xrefs(args, true);
+}
+
+PyObject *api_xrefs_from(PyObject *self, PyObject *args)
+{
+    Q_UNUSED(self);
+    return xrefs(args, false);
+}
+
+PyObject *api_flags(PyObject *self, PyObject *args)
+{
+    Q_UNUSED(self);
+    const char *space = "";
+    if (!PyArg_ParseTuple(args, "|s:flagspace", &space)) {
+        return NULL;
+    }
+    return toList(
+        Core()->getAllFlags(QString::fromUtf8(space)),
+        flagType,
+        [](PyObject *item, const FlagDescription &flag) {
+            PyStructSequence_SetItem(item, 0, toPython(flag.offset));
+            PyStructSequence_SetItem(item, 1, toPython(flag.size));
+            PyStructSequence_SetItem(item, 2, toPython(flag.name));
+            PyStructSequence_SetItem(item, 3, toPython(flag.realname));
+        });
+}
+
+PyObject *api_strings(PyObject *self, PyObject *null)
+{
+    Q_UNUSED(self)
+    Q_UNUSED(null)
+    return toList(
+        Core()->getAllStrings(),
+        stringType,
+        [](PyObject *item, const StringDescription &string) {
+            PyStructSequence_SetItem(item, 0, toPython(string.vaddr));
+            PyStructSequence_SetItem(item, 1, toPython(string.string));
+            PyStructSequence_SetItem(item, 2, toPython(string.type));
+            PyStructSequence_SetItem(item, 3, toPython(string.section));
+            PyStructSequence_SetItem(item, 4, toPython(ut64(string.length)));
+            PyStructSequence_SetItem(item, 5, toPython(ut64(string.size)));
+        });
+}
+
+PyObject *api_read(PyObject *self, PyObject *args)
+{
+    Q_UNUSED(self);
+    unsigned long long addr;
+    Py_ssize_t len;
+    if (!PyArg_ParseTuple(args, "Kn:read", &addr, &len)) {
+        return NULL;
+    }
+    if (len < 0) {
+        PyErr_SetString(PyExc_ValueError, "negative length");
+        return NULL;
+    }
+    if (len > MAX_READ_SIZE) {
+        PyErr_SetString(PyExc_OverflowError, "length over 256 MiB, read in chunks");
+        return NULL;
+    }
+
+    // r2 reads straight into the bytes object the view exposes
+    PyObject *bytes = PyBytes_FromStringAndSize(NULL, len);
+    if (!bytes) {
+        return NULL;
+    }
+    ut8 *buf = reinterpret_cast<ut8 *>(PyBytes_AsString(bytes));
+    if (len > 0) {
+        RCoreReadLocked core = Core()->coreRead();
+        if (!Core()->ioReadAt(core, addr, buf, int(len))) {
+            memset(buf, 0xff, len);
+        }
+    }
+    PyObject *view = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    return view;
+}
+
 PyObject *api_refresh(PyObject *self, PyObject *args)
 {
     Q_UNUSED(self);
@@ -56,6 +357,20 @@ PyObject *api_message(PyObject *self, PyObject *args, PyObject *kwargs)
 PyMethodDef IaitoMethods[]
     = {{"version", api_version, METH_NOARGS, "Returns Iaito current version"},
        {"cmd", api_cmd, METH_VARARGS, "Execute a command inside Iaito"},
+       {"cmds",
+        api_cmds,
+        METH_VARARGS,
+        "Execute an iterable of commands with the core held, returns the list of outputs"},
+       {"functions", api_functions, METH_NOARGS, "List of Function for all functions"},
+       {"basic_blocks",
+        api_basic_blocks,
+        METH_VARARGS,
+        "List of BasicBlock of the function containing addr"},
+       {"xrefs_to", api_xrefs_to, METH_VARARGS, "List of Xref to addr"},
+       {"xrefs_from", api_xrefs_from, METH_VARARGS, "List of Xref from addr"},
+       {"flags", api_flags, METH_VARARGS, "List of Flag, optionally in one flagspace"},
+       {"strings", api_strings, METH_NOARGS, "List of String found in the binary"},
+       {"read", api_read, METH_VARARGS, "memoryview over len bytes read at addr"},
        {"refresh", api_refresh, METH_NOARGS, "Refresh Iaito widgets"},
        {"message",
         (PyCFunction) (void *) /* don't remove this double cast! */ api_message,
@@ -66,9 +381,38 @@ PyMethodDef IaitoMethods[]
 PyModuleDef IaitoModule
     = {PyModuleDef_HEAD_INIT, "_cutter", NULL, -1, IaitoMethods, NULL, NULL, NULL, NULL};
 
+static bool addType(PyObject *module, PyTypeObject **type, PyStructSequence_Desc *desc)
+{
+    if (!*type) {
+        *type = PyStructSequence_NewType(desc);
+        if (!*type) {
+            return false;
+        }
+    }
+    // The name after "_cutter."
+    const char *name = desc->name + 8;
+    Py_INCREF(*type);
+    if (PyModule_AddObject(module, name, reinterpret_cast<PyObject *>(*type)) < 0) {
+        Py_DECREF(*type);
+        return false;
+    }
+    return true;
+}
+
 PyObject *PyInit_api()
 {
-    return PyModule_Create(&IaitoModule);
+    PyObject *module = PyModule_Create(&IaitoModule);
+    if (!module) {
+        return NULL;
+    }
+    if (!addType(module, &functionType, &functionDesc)
+        || !addType(module, &basicBlockType, &basicBlockDesc)
+        || !addType(module, &xrefType, &xrefDesc) || !addType(module, &flagType, &flagDesc)
+        || !addType(module, &stringType, &stringDesc)) {
+        Py_DECREF(module);
+        return NULL;
+    }
+    return module;
 }
 
 #endif // IAITO_ENABLE_PYTHON
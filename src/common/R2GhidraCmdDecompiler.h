@@ -19,6 +19,7 @@ public:
     explicit R2GhidraCmdDecompiler(QObject *parent = nullptr);
     RCodeMeta *decompileSync(RVA addr) override;
     void decompileAt(RVA addr) override;
+    QString getBatchCommand() const override { return QStringLiteral("pdg"); }
 
     bool isRunning() override { return task != nullptr; }
 
@@ -20,6 +20,7 @@ public:
 
     RCodeMeta *decompileSync(RVA addr) override;
     void decompileAt(RVA addr) override;
+    QString getBatchCommand() const override { return QStringLiteral("pdz"); }
 
     bool isRunning() override { return task != nullptr; }
 
@@ -0,0 +1,354 @@
+#include "SearchTask.h"
+#include "TempConfig.h"
+
+#include <QMutex>
+#include <QThread>
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+int hexDigit(QChar c)
+{
+    if (c >= '0' && c <= '9') {
+        return c.unicode() - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c.unicode() - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c.unicode() - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * @brief Parse hexpairs like r2 does for /x
+ * @param mask if given, '.' is accepted for any nibble and the nibbles that
+ * have to match are set in it
+ */
+bool parseHexPairs(const QString &hex, QByteArray &bytes, QByteArray *mask)
+{
+    if (hex.isEmpty() || hex.size() % 2) {
+        return false;
+    }
+    for (int i = 0; i < hex.size(); i += 2) {
+        int byte = 0;
+        int byteMask = 0;
+        for (int k = 0; k < 2; k++) {
+            QChar c = hex[i + k];
+            int digit = hexDigit(c);
+            byte <<= 4;
+            byteMask <<= 4;
+            if (digit >= 0) {
+                byte |= digit;
+                byteMask |= 0xf;
+            } else if (c != '.' || !mask) {
+                return false;
+            }
+        }
+        bytes.append(char(byte));
+        if (mask) {
+            mask->append(char(byteMask));
+        }
+    }
+    return true;
+}
+} // namespace
+
+SearchTask::SearchTask(const QString &searchFor, const QString &space, int maxHits)
+    : command(space + QStringLiteral(" ") + searchFor)
+    , space(space)
+    , maxHits(maxHits)
+{
+    RCoreLocked core(Core());
+    overlap = r_config_get_b(core->config, "search.overlap");
+    align = r_config_get_i(core->config, "search.align");
+    if (!compilePattern(searchFor, r_config_get_b(core->config, "cfg.bigendian"))) {
+        pattern.clear();
+        mask.clear();
+    }
+
+    RList *boundaries = r_core_get_boundaries_prot(core, -1, nullptr, "search");
+    if (!boundaries) {
+        return;
+    }
+    RListIter *it;
+    RIOMap *map;
+    IaitoRListForeach(boundaries, it, RIOMap, map)
+    {
+        const RVA end = r_io_map_end(map);
+        for (RVA from = r_io_map_begin(map); from < end;) {
+            RVA to = end - from > SLICE_SIZE ? from + SLICE_SIZE : end;
+            slices.append({from, to, end});
+            from = to;
+        }
+    }
+    r_list_free(boundaries);
+}
+
+bool SearchTask::compilePattern(const QString &searchFor, bool bigEndian)
+{
+    if (space == "/j") {
+        pattern = searchFor.toUtf8();
+    } else if (space == "/wj") {
+        for (QChar c : searchFor) {
+            pattern.append(char(c.unicode() & 0xff));
+            pattern.append(char(c.unicode() >> 8));
+        }
+    } else if (space == "/xj") {
+        QString hex = searchFor;
+        hex.remove(QLatin1Char(' '));
+        QStringList parts = hex.split(QLatin1Char(':'));
+        if (parts.size() > 2 || !parseHexPairs(parts[0], pattern, &mask)) {
+            return false;
+        }
+        if (parts.size() == 2) {
+            QByteArray userMask;
+            if (!parseHexPairs(parts[1], userMask, nullptr) || userMask.size() > mask.size()) {
+                return false;
+            }
+            for (int i = 0; i < userMask.size(); i++) {
+                mask[i] = char(mask[i] & userMask[i]);
+            }
+        }
+    } else if (space.startsWith("/v") && space.size() == 4) {
+        int width = space[2].digitValue();
+        bool ok;
+        ut64 value = searchFor.trimmed().toULongLong(&ok, 0);
+        if (!ok || (width != 1 && width != 2 && width != 4 && width != 8)
+            || (width < 8 && value >> (width * 8))) {
+            return false;
+        }
+        for (int i = 0; i < width; i++) {
+            int shift = (bigEndian ? width - 1 - i : i) * 8;
+            pattern.append(char((value >> shift) & 0xff));
+        }
+    } else {
+        return false;
+    }
+
+    if (pattern.isEmpty()) {
+        return false;
+    }
+    if (mask.isEmpty()) {
+        mask.fill('\xff', pattern.size());
+    }
+    for (int i = 0; i < pattern.size(); i++) {
+        pattern[i] = char(pattern[i] & mask[i]);
+        if (anchor < 0 && mask[i] == '\xff') {
+            anchor = i;
+        }
+    }
+    return true;
+}
+
+bool SearchTask::step()
+{
+    if (nextSlice >= slices.size() || (maxHits > 0 && hits >= maxHits)) {
+        return false;
+    }
+    const Slice &slice = slices.at(nextSlice++);
+    QList<SearchDescription> found = pattern.isEmpty() ? searchSlice(slice)
+                                                       : matchSliceParallel(slice);
+    return reportHits(found) && nextSlice < slices.size();
+}
+
+void SearchTask::runTask()
+{
+    if (pattern.isEmpty()) {
+        while (!isInterrupted() && step()) {}
+        return;
+    }
+
+    // Slices are matched in any order, the hits are reported once all the
+    // slices before them are done
+    QVector<QList<SearchDescription>> results(slices.size());
+    QVector<bool> done(slices.size(), false);
+    QMutex resultsMutex;
+    std::atomic<int> next(0);
+    std::atomic<bool> limitReached(false);
+    auto worker = [&]() {
+        for (int i = next++; i < slices.size() && !isInterrupted() && !limitReached; i = next++) {
+            QList<SearchDescription> found = matchSlice(slices.at(i));
+            QMutexLocker locker(&resultsMutex);
+            results[i] = found;
+            done[i] = true;
+            while (nextSlice < slices.size() && done[nextSlice] && !limitReached) {
+                if (!reportHits(results[nextSlice])) {
+                    limitReached = true;
+                }
+                results[nextSlice++].clear();
+            }
+        }
+    };
+
+    int threads = qBound(1, QThread::idealThreadCount(), slices.size());
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+}
+
+QList<SearchDescription> SearchTask::searchSlice(const Slice &slice) const
+{
+    QJsonDocument doc;
+    {
+        RVA to = slice.end - slice.to > SLICE_OVERLAP ? slice.to + SLICE_OVERLAP : slice.end;
+        // Held from setting the range to restoring it, so neither another
+        // search nor the GUI sees the temporary values. The command runs on
+        // this thread with cmdj() so that it is covered by the lock too.
+        RCoreLocked core(Core());
+        TempConfig tempConfig;
+        tempConfig.set("search.in", "range")
+            .set("search.from", RAddressString(slice.from))
+            .set("search.to", RAddressString(to))
+            .set("search.maxhits", maxHits > 0 ? maxHits - hits : 0);
+        doc = Core()->cmdj(command);
+    }
+
+    QList<SearchDescription> found;
+    for (const SearchDescription &hit : IaitoCore::parseSearchJson(space, doc)) {
+        // Hits in the overlap belong to the next slice
+        if (hit.offset >= slice.from && hit.offset < slice.to) {
+            found << hit;
+        }
+    }
+    return found;
+}
+
+SearchTask::SliceBytes SearchTask::readSlice(const Slice &slice) const
+{
+    // Read the start of the next slice too, for the hits crossing the border
+    const RVA extra = RVA(pattern.size() - 1);
+    RVA readTo = slice.end - slice.to > extra ? slice.to + extra : slice.end;
+    const int size = int(readTo - slice.from);
+    SliceBytes bytes;
+    bytes.buf.fill('\xff', size);
+    const auto data = reinterpret_cast<ut8 *>(bytes.buf.data());
+
+    RCoreReadLocked core(Core());
+    if (Core()->ioReadAt(core, slice.from, data, size)) {
+        bytes.runs.append({0, size});
+        return bytes;
+    }
+    for (int page = 0; page < size; page += IO_PAGE_SIZE) {
+        const int pageSize = qMin(IO_PAGE_SIZE, size - page);
+        if (!Core()->ioReadAt(core, slice.from + page, data + page, pageSize)) {
+            continue;
+        }
+        if (!bytes.runs.isEmpty() && bytes.runs.last().second == page) {
+            bytes.runs.last().second += pageSize;
+        } else {
+            bytes.runs.append({page, page + pageSize});
+        }
+    }
+    return bytes;
+}
+
+QList<SearchDescription> SearchTask::matchSlice(const Slice &slice) const
+{
+    return matchRange(slice, readSlice(slice), 0, int(slice.to - slice.from));
+}
+
+QList<SearchDescription> SearchTask::matchSliceParallel(const Slice &slice) const
+{
+    const SliceBytes bytes = readSlice(slice);
+    const int sliceSize = int(slice.to - slice.from);
+    const int parts = qBound(1, QThread::idealThreadCount(), sliceSize / MIN_MATCH_PART + 1);
+    QVector<int> bounds;
+    for (int i = 0; i <= parts; i++) {
+        bounds << int(qint64(sliceSize) * i / parts);
+    }
+
+    QVector<QList<SearchDescription>> results(parts);
+    auto match = [&](int part) {
+        results[part] = matchRange(slice, bytes, bounds[part], bounds[part + 1]);
+    };
+    std::vector<std::thread> pool;
+    for (int i = 1; i < parts; i++) {
+        pool.emplace_back(match, i);
+    }
+    match(0);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    QList<SearchDescription> found = results[0];
+    for (int i = 1; i < parts; i++) {
+        // Without overlap a hit crossing into the part hides the ones it
+        // covers, match the part again from its end like a single pass would
+        if (!overlap && !found.isEmpty() && !results[i].isEmpty()) {
+            const RVA previousEnd = found.last().offset + pattern.size();
+            if (results[i].first().offset < previousEnd) {
+                results[i] = matchRange(slice, bytes, int(previousEnd - slice.from), bounds[i + 1]);
+            }
+        }
+        found += results[i];
+    }
+    return found;
+}
+
+QList<SearchDescription> SearchTask::matchRange(
+    const Slice &slice, const SliceBytes &bytes, int from, int to) const
+{
+    const int len = pattern.size();
+    const auto data = reinterpret_cast<const ut8 *>(bytes.buf.constData());
+    const auto pat = reinterpret_cast<const ut8 *>(pattern.constData());
+    const auto msk = reinterpret_cast<const ut8 *>(mask.constData());
+    QList<SearchDescription> found;
+    for (const auto &run : bytes.runs) {
+        const int last = qMin(run.second - len, to - 1);
+        for (int i = qMax(run.first, from); i <= last;) {
+            if (anchor >= 0) {
+                // memchr is vectorized, only check the candidates it finds
+                auto candidate = static_cast<const ut8 *>(
+                    memchr(data + i + anchor, pat[anchor], last - i + 1));
+                if (!candidate) {
+                    break;
+                }
+                i = int(candidate - data) - anchor;
+            }
+            if (align > 1 && (slice.from + i) % align) {
+                i++;
+                continue;
+            }
+            int k = 0;
+            while (k < len && (data[i + k] & msk[k]) == pat[k]) {
+                k++;
+            }
+            if (k < len) {
+                i++;
+                continue;
+            }
+            SearchDescription hit;
+            hit.offset = slice.from + i;
+            hit.size = len;
+            hit.data = bytes.buf.mid(i, len).toHex();
+            found << hit;
+            if (maxHits > 0 && found.size() >= maxHits) {
+                return found;
+            }
+            i += overlap ? 1 : len;
+        }
+    }
+    return found;
+}
+
+bool SearchTask::reportHits(QList<SearchDescription> found)
+{
+    if (maxHits > 0 && hits + found.size() >= maxHits) {
+        found.erase(found.begin() + (maxHits - hits), found.end());
+    }
+    hits += found.size();
+    if (!found.isEmpty()) {
+        emit hitsFound(found);
+    }
+    return maxHits <= 0 || hits < maxHits;
+}
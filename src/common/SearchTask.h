@@ -0,0 +1,116 @@
+#ifndef SEARCHTASK_H
+#define SEARCHTASK_H
+
+#include "common/AsyncTask.h"
+#include "core/Iaito.h"
+
+#include <QPair>
+#include <QVector>
+
+/**
+ * @brief Runs a search command over the search.in boundaries and reports the
+ * hits in chunks as the search goes.
+ *
+ * The boundaries are searched slice by slice, so the first hits show up
+ * before a big memory map is done, and interrupting the task stops it after
+ * the current slice. step() can be called instead of running the task to
+ * search slice by slice on the GUI thread.
+ *
+ * Byte patterns (strings, wide strings, hex strings and values) are matched
+ * natively instead of going through r2. runTask() then spreads the slices
+ * over worker threads, step() reads the slice on the calling thread and
+ * matches parts of it on worker threads. Hits are still reported in address
+ * order.
+ */
+class SearchTask : public AsyncTask
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param space search command, like /xj
+     * @param maxHits stop after that many hits, 0 for no limit
+     */
+    SearchTask(const QString &searchFor, const QString &space, int maxHits);
+
+    QString getTitle() override { return tr("Searching"); }
+
+    /**
+     * @brief Search the next slice
+     * @return false once the search is done
+     */
+    bool step();
+
+    int getHitCount() const { return hits; }
+
+signals:
+    void hitsFound(const QList<SearchDescription> &hits);
+
+protected:
+    void runTask() override;
+
+private:
+    static constexpr RVA SLICE_SIZE = 16 * 1024 * 1024;
+    // bytes searched past the end of a slice, for the hits crossing it
+    static constexpr RVA SLICE_OVERLAP = 0x1000;
+    // granularity of the reads retried when a slice is not entirely mapped
+    static constexpr int IO_PAGE_SIZE = 0x1000;
+    // smallest part of a slice step() gives to a thread
+    static constexpr int MIN_MATCH_PART = 1024 * 1024;
+
+    struct Slice
+    {
+        RVA from;
+        RVA to;
+        // end of the boundary the slice is part of
+        RVA end;
+    };
+
+    struct SliceBytes
+    {
+        // the slice and the start of the next one, unmapped bytes are 0xff
+        QByteArray buf;
+        // runs of mapped bytes [begin, end) in buf
+        QVector<QPair<int, int>> runs;
+    };
+
+    QString command;
+    QString space;
+    int maxHits;
+    int hits = 0;
+
+    // native pattern, empty if the search goes through r2
+    QByteArray pattern;
+    // bits of pattern that have to match
+    QByteArray mask;
+    // index of a pattern byte without wildcard bits, -1 if there is none
+    int anchor = -1;
+    // search.overlap, whether hits may overlap
+    bool overlap = false;
+    // search.align, hits start at multiples of it
+    ut64 align = 0;
+
+    QVector<Slice> slices;
+    int nextSlice = 0;
+
+    bool compilePattern(const QString &searchFor, bool bigEndian);
+    QList<SearchDescription> searchSlice(const Slice &slice) const;
+    SliceBytes readSlice(const Slice &slice) const;
+    QList<SearchDescription> matchSlice(const Slice &slice) const;
+    /**
+     * @brief Match the slice split in parts matched in parallel
+     */
+    QList<SearchDescription> matchSliceParallel(const Slice &slice) const;
+    /**
+     * @return hits starting at offsets from to to of the slice
+     */
+    QList<SearchDescription> matchRange(
+        const Slice &slice, const SliceBytes &bytes, int from, int to) const;
+    /**
+     * @brief Emit hits up to the limit
+     * @return false once the limit is reached
+     */
+    bool reportHits(QList<SearchDescription> found);
+};
+
+#endif // SEARCHTASK_H
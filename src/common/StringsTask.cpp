@@ -0,0 +1,275 @@
+#include "StringsTask.h"
+
+#include <QThread>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+bool isPrintable(ut8 c)
+{
+    return (c >= 0x20 && c < 0x7f) || c == '\t';
+}
+
+/**
+ * @return size in bytes of the utf16le run of printable ascii characters at
+ * data, chars is set to its length
+ */
+int wideRun(const ut8 *data, int len, int maxChars, int &chars)
+{
+    chars = 0;
+    int size = 0;
+    while (size + 1 < len && chars < maxChars && !data[size + 1] && isPrintable(data[size])) {
+        size += 2;
+        chars++;
+    }
+    return size;
+}
+
+/**
+ * @return size in bytes of the run of printable ascii characters at data,
+ * and of utf8 ones when allowUtf8 is set, chars is set to its length
+ */
+int byteRun(const ut8 *data, int len, int maxChars, bool allowUtf8, int &chars, bool &utf8)
+{
+    chars = 0;
+    utf8 = false;
+    int size = 0;
+    while (size < len && chars < maxChars) {
+        if (isPrintable(data[size])) {
+            size++;
+            chars++;
+            continue;
+        }
+        if (!allowUtf8) {
+            break;
+        }
+        RRune ch;
+        int seq = r_utf8_decode(data + size, len - size, &ch);
+        if (seq < 2 || !QChar::isPrint(ch)) {
+            break;
+        }
+        size += seq;
+        chars++;
+        utf8 = true;
+    }
+    return size;
+}
+} // namespace
+
+StringsTask::StringsTask()
+{
+    RCoreReadLocked core(Core());
+    int min = r_config_get_i(core->config, "bin.str.min");
+    if (min > 0) {
+        minLength = min;
+    }
+    int max = r_config_get_i(core->config, "bin.str.max");
+    if (max > 0) {
+        maxLength = qMin(max, MAX_STRING_LENGTH);
+    }
+    // Encodings the scanner has no decoder for are guessed like by default
+    const QString enc = QString::fromUtf8(r_config_get(core->config, "bin.str.enc"));
+    if (enc == QLatin1String("ascii") || enc == QLatin1String("latin1")) {
+        encodings = Ascii;
+    } else if (enc == QLatin1String("utf8")) {
+        encodings = Ascii | Utf8;
+    } else if (enc == QLatin1String("utf16le")) {
+        encodings = Wide;
+    }
+    const char *strFilter = r_config_get(core->config, "bin.str.filter");
+    const char *strPurge = r_config_get(core->config, "bin.str.purge");
+    filtered = (strFilter && *strFilter) || (strPurge && *strPurge);
+
+    RListIter *it;
+    RBinSection *sect;
+    IaitoRListForeach(r_bin_get_sections(core->bin), it, RBinSection, sect)
+    {
+        ut64 size = sect->vsize ? qMin(sect->size, sect->vsize) : sect->size;
+        if (sect->is_segment || !size) {
+            continue;
+        }
+        ranges.append({sect->vaddr, size, QString::fromUtf8(sect->name), 0});
+    }
+    if (ranges.isEmpty()) {
+        // Raw files and memory dumps, scan everything that is mapped
+        ut64 size = r_io_size(core->io);
+        if (size) {
+            ranges.append({0, size, QString(), 0});
+        }
+    }
+    threads = qBound(1, QThread::idealThreadCount(), qMax(1, int(ranges.size())));
+}
+
+bool StringsTask::step()
+{
+    // The next window of the first sections not done, read here since the
+    // core belongs to this thread, then scanned in parallel
+    QVector<int> batch;
+    for (int i = 0; i < ranges.size() && batch.size() < threads; i++) {
+        if (ranges[i].offset < ranges[i].size) {
+            batch << i;
+        }
+    }
+    if (batch.isEmpty()) {
+        return false;
+    }
+    QVector<QByteArray> windows;
+    for (int i : std::as_const(batch)) {
+        windows << readWindow(ranges[i], ranges[i].offset);
+    }
+
+    QVector<QList<StringDescription>> found(batch.size());
+    QVector<ut64> ends(batch.size());
+    auto scan = [&](int job) {
+        const Range &range = ranges[batch[job]];
+        ends[job] = scanWindow(range, range.offset, windows[job], found[job]);
+    };
+    std::vector<std::thread> pool;
+    for (int job = 1; job < batch.size(); job++) {
+        pool.emplace_back(scan, job);
+    }
+    scan(0);
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+
+    for (int job = 0; job < batch.size(); job++) {
+        Range &range = ranges[batch[job]];
+        range.offset = ends[job];
+        if (range.offset >= range.size) {
+            logRangeDone(batch[job]);
+        }
+        filter(found[job]);
+        if (!found[job].isEmpty()) {
+            emit stringsFound(found[job]);
+        }
+    }
+    for (const Range &range : std::as_const(ranges)) {
+        if (range.offset < range.size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void StringsTask::runTask()
+{
+    std::atomic<int> next(0);
+    auto worker = [this, &next]() {
+        for (int i = next++; i < ranges.size() && !isInterrupted(); i = next++) {
+            scanRange(i);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+}
+
+void StringsTask::scanRange(int index)
+{
+    const Range &range = ranges.at(index);
+    ut64 offset = 0;
+    while (offset < range.size && !isInterrupted()) {
+        QList<StringDescription> strings;
+        offset = scanWindow(range, offset, readWindow(range, offset), strings);
+        filter(strings);
+        if (!strings.isEmpty()) {
+            emit stringsFound(strings);
+        }
+    }
+    if (offset >= range.size) {
+        logRangeDone(index);
+    }
+}
+
+QByteArray StringsTask::readWindow(const Range &range, ut64 offset) const
+{
+    // Strings starting in the window may continue past it, read enough to
+    // get them whole
+    const int readSize = int(qMin(WINDOW_SIZE + 2 * MAX_STRING_LENGTH + 2, range.size - offset));
+    return Core()->ioRead(range.addr + offset, readSize);
+}
+
+ut64 StringsTask::scanWindow(
+    const Range &range, ut64 offset, const QByteArray &buf, QList<StringDescription> &strings) const
+{
+    const int windowSize = int(qMin(WINDOW_SIZE, range.size - offset));
+    const int readSize = buf.size();
+    auto data = reinterpret_cast<const ut8 *>(buf.constData());
+
+    int p = 0;
+    while (p < windowSize && p < readSize) {
+        StringDescription string;
+        int chars = 0;
+        int size = 0;
+        if (encodings & Wide) {
+            size = wideRun(data + p, readSize - p, maxLength, chars);
+        }
+        if (chars >= minLength) {
+            string.type = QString::fromUtf8(r_bin_string_type(R_STRING_TYPE_WIDE));
+            string.string.reserve(chars);
+            for (int i = 0; i < size; i += 2) {
+                string.string.append(QLatin1Char(char(data[p + i])));
+            }
+            int end = p + size;
+            string.size = size + (end + 1 < readSize && !data[end] && !data[end + 1] ? 2 : 0);
+        } else {
+            bool utf8 = false;
+            size = 0;
+            chars = 0;
+            if (encodings & (Ascii | Utf8)) {
+                size = byteRun(data + p, readSize - p, maxLength, encodings & Utf8, chars, utf8);
+            }
+            if (chars < minLength) {
+                // a wide string may start inside a short run
+                p++;
+                continue;
+            }
+            string.type = QString::fromUtf8(
+                r_bin_string_type(utf8 ? R_STRING_TYPE_UTF8 : R_STRING_TYPE_ASCII));
+            string.string = QString::fromUtf8(buf.constData() + p, size);
+            int end = p + size;
+            string.size = size + (end < readSize && !data[end] ? 1 : 0);
+        }
+        string.vaddr = range.addr + offset + p;
+        string.length = chars;
+        string.section = range.section;
+        strings << string;
+        p += size;
+    }
+    return offset + qMax(p, windowSize);
+}
+
+void StringsTask::filter(QList<StringDescription> &strings) const
+{
+    if (!filtered || strings.isEmpty()) {
+        return;
+    }
+    RCoreReadLocked core(Core());
+    QList<StringDescription> kept;
+    for (const StringDescription &string : std::as_const(strings)) {
+        if (r_bin_string_filter(core->bin, string.string.toUtf8().constData(), string.vaddr)) {
+            kept << string;
+        }
+    }
+    strings = kept;
+}
+
+void StringsTask::logRangeDone(int index)
+{
+    const QString &section = ranges.at(index).section;
+    QMutexLocker locker(&logMutex);
+    rangesDone++;
+    log(tr("Scanned %1 (%2/%3)")
+            .arg(section.isEmpty() ? tr("file") : section)
+            .arg(rangesDone)
+            .arg(ranges.size()));
+}
@@ -1,30 +1,87 @@
-
 #ifndef STRINGSASYNCTASK_H
 #define STRINGSASYNCTASK_H
 
 #include "common/AsyncTask.h"
 #include "core/Iaito.h"
 
+#include <QMutex>
+#include <QVector>
+
+/**
+ * @brief Scans the sections for ascii, utf8 and utf16le strings and reports
+ * them in chunks as the scan goes.
+ *
+ * Sections are read window by window, so memory use does not depend on the
+ * size of the file and interrupting the task stops it after the current
+ * window. bin.str.min, bin.str.max and bin.str.enc choose the strings the
+ * way they do for izz, bin.str.filter and bin.str.purge are applied with
+ * r2's own filter. runTask() spreads the sections over worker threads,
+ * step() can be called instead on the GUI thread, it reads the next window
+ * of several sections there and scans them in parallel.
+ */
 class StringsTask : public AsyncTask
 {
     Q_OBJECT
 
 public:
+    StringsTask();
+
     QString getTitle() override { return tr("Searching for Strings"); }
 
+    /**
+     * @brief Scan the next window of the sections in progress, one per
+     * thread
+     * @return false once every section is done
+     */
+    bool step();
+
 signals:
-    void stringSearchFinished(const QList<StringDescription> &strings);
+    void stringsFound(const QList<StringDescription> &strings);
 
 protected:
-    void runTask() override
+    void runTask() override;
+
+private:
+    static constexpr ut64 WINDOW_SIZE = 1024 * 1024;
+    // longer strings are split
+    static constexpr int MAX_STRING_LENGTH = 4096;
+
+    enum Encoding { Ascii = 1, Utf8 = 2, Wide = 4 };
+
+    struct Range
     {
-#if MONOTHREAD
-        QList<StringDescription> strings;
-#else
-        auto strings = Core()->getAllStrings();
-#endif
-        emit stringSearchFinished(strings);
-    }
+        RVA addr;
+        ut64 size;
+        QString section;
+        // scanned so far, for step()
+        ut64 offset;
+    };
+
+    QVector<Range> ranges;
+    int minLength = 4;
+    int maxLength = MAX_STRING_LENGTH;
+    int encodings = Ascii | Utf8 | Wide;
+    // whether bin.str.filter or bin.str.purge are set
+    bool filtered = false;
+    int threads = 1;
+
+    QMutex logMutex;
+    int rangesDone = 0;
+
+    void scanRange(int index);
+    QByteArray readWindow(const Range &range, ut64 offset) const;
+    /**
+     * @brief Collect the strings starting in the window at offset, buf holds
+     * the bytes read by readWindow()
+     * @return offset following the last byte looked at
+     */
+    ut64 scanWindow(
+        const Range &range,
+        ut64 offset,
+        const QByteArray &buf,
+        QList<StringDescription> &strings) const;
+    void filter(QList<StringDescription> &strings) const;
+    void logRangeDone(int index);
 };
 
 #endif // STRINGSASYNCTASK_H
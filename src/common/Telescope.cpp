@@ -0,0 +1,217 @@
+#include "Telescope.h"
+#include "core/Iaito.h"
+
+#include <cstring>
+
+Telescope::Telescope(IaitoCore *core)
+    : QObject(core)
+{
+    // The nodes keep flag and function names, which change without a new
+    // debug stop
+    connect(core, &IaitoCore::flagsChanged, this, &Telescope::invalidate);
+    connect(core, &IaitoCore::functionRenamed, this, &Telescope::invalidate);
+    connect(core, &IaitoCore::refreshAll, this, &Telescope::invalidate);
+}
+
+void Telescope::invalidate()
+{
+    outdated = true;
+}
+
+void Telescope::begin(RCore *core, quint64 generation)
+{
+    this->core = core;
+    bits = r_config_get_i(core->config, "asm.bits");
+    if (generation != this->generation || outdated) {
+        this->generation = generation;
+        outdated = false;
+        nodes.clear();
+        results.clear();
+        windowBase = 0;
+        window.clear();
+    }
+}
+
+void Telescope::setWindow(RVA base, const QByteArray &window)
+{
+    windowBase = base;
+    this->window = window;
+}
+
+QByteArray Telescope::read(RVA addr, int size)
+{
+    if (addr >= windowBase && addr - windowBase <= ut64(window.size())
+        && ut64(window.size()) - (addr - windowBase) >= ut64(size)) {
+        return window.mid(int(addr - windowBase), size);
+    }
+    QByteArray buf(size, 0);
+    Core()->ioReadAt(core, addr, reinterpret_cast<ut8 *>(buf.data()), size);
+    return buf;
+}
+
+Telescope::Node &Telescope::node(RVA addr)
+{
+    auto it = nodes.find(addr);
+    if (it != nodes.end()) {
+        return *it;
+    }
+
+    Node node;
+    node.type = r_core_anal_address(core, addr);
+
+    // Search for the section the addr is in, avoid duplication for heap/stack
+    // with type
+    if (!(node.type & R_ANAL_ADDR_TYPE_HEAP || node.type & R_ANAL_ADDR_TYPE_STACK)) {
+        RDebugMap *map = r_debug_map_get(core->dbg, addr);
+        if (map && map->name && map->name[0]) {
+            node.mapName = QString::fromUtf8(map->name);
+        }
+
+        RBinSection *sect = r_bin_get_section_at(r_bin_cur_object(core->bin), addr, true);
+        if (sect && sect->name[0]) {
+            node.section = QString::fromUtf8(sect->name);
+        }
+    }
+
+    // Check if the address points to a register
+    RFlagItem *fi = r_flag_get_i(core->flags, addr);
+    if (fi) {
+        RRegItem *r = r_reg_get(core->dbg->reg, fi->name, -1);
+        if (r) {
+            node.reg = QString::fromUtf8(r->name);
+#if R2_VERSION_NUMBER >= 50709
+            r_unref(r);
+#endif
+        }
+    }
+
+    RAnalFunction *fcn = r_anal_get_fcn_in(core->anal, addr, 0);
+    if (fcn) {
+        node.function = QString::fromUtf8(fcn->name);
+    }
+
+    if (node.type & R_ANAL_ADDR_TYPE_EXEC) {
+        QByteArray buf = read(addr, 32);
+        r_asm_set_pc(core->rasm, addr);
+#if R2_VERSION_NUMBER >= 50709
+        RAnalOp op;
+        r_anal_op_init(&op);
+        r_asm_disassemble(core->rasm, &op, (unsigned char *) buf.data(), buf.size());
+        node.instruction = QString::fromUtf8(op.mnemonic);
+        r_anal_op_fini(&op);
+#else
+        RAsmOp op;
+        r_asm_disassemble(core->rasm, &op, (unsigned char *) buf.data(), buf.size());
+        node.instruction = QString::fromUtf8(r_asm_op_get_asm(&op));
+#endif
+    } else if (node.type & R_ANAL_ADDR_TYPE_READ) {
+        QByteArray buf = read(addr, sizeof(ut64));
+        if (bits == 64) {
+            ut64 n64;
+            memcpy(&n64, buf.constData(), sizeof(n64));
+            node.value = n64;
+        } else {
+            ut32 n32;
+            memcpy(&n32, buf.constData(), sizeof(n32));
+            node.value = n32;
+        }
+        node.hasValue = true;
+    }
+
+    return *nodes.insert(addr, node);
+}
+
+QJsonObject Telescope::refs(RVA addr, int depth)
+{
+    QJsonObject json;
+    if (depth < 1 || addr == UT64_MAX) {
+        return json;
+    }
+    const QPair<RVA, int> key(addr, depth);
+    auto cached = results.constFind(key);
+    if (cached != results.constEnd()) {
+        return *cached;
+    }
+
+    // copied, the recursion below may add nodes
+    const Node node = this->node(addr);
+    json["addr"] = QString::number(addr);
+    if (!node.mapName.isEmpty()) {
+        json["mapname"] = node.mapName;
+    }
+    if (!node.section.isEmpty()) {
+        json["section"] = node.section;
+    }
+    if (!node.reg.isEmpty()) {
+        json["reg"] = node.reg;
+    }
+    if (!node.function.isEmpty()) {
+        json["fcn"] = node.function;
+    }
+
+    const ut64 type = node.type;
+    if (type != 0) {
+        if (type & R_ANAL_ADDR_TYPE_HEAP) {
+            json["type"] = "heap";
+        } else if (type & R_ANAL_ADDR_TYPE_STACK) {
+            json["type"] = "stack";
+        } else if (type & R_ANAL_ADDR_TYPE_PROGRAM) {
+            json["type"] = "program";
+        } else if (type & R_ANAL_ADDR_TYPE_LIBRARY) {
+            json["type"] = "library";
+        } else if (type & R_ANAL_ADDR_TYPE_ASCII) {
+            json["type"] = "ascii";
+        } else if (type & R_ANAL_ADDR_TYPE_SEQUENCE) {
+            json["type"] = "sequence";
+        }
+
+        QString perms;
+        if (type & R_ANAL_ADDR_TYPE_READ) {
+            perms += "r";
+        }
+        if (type & R_ANAL_ADDR_TYPE_WRITE) {
+            perms += "w";
+        }
+        if (type & R_ANAL_ADDR_TYPE_EXEC) {
+            perms += "x";
+            json["asm"] = node.instruction;
+        }
+        if (!perms.isEmpty()) {
+            json["perms"] = perms;
+        }
+    }
+
+    // Try to telescope further if depth permits it
+    if (node.hasValue) {
+        const ut64 n = node.value;
+        // The value of the next address will serve as an indication that
+        // there's more to telescope if we have reached the depth limit
+        json["value"] = QString::number(n);
+        if (n != addr) {
+            // Make sure we aren't telescoping the same address
+            QJsonObject ref = refs(n, depth - 1);
+            if (!ref.empty() && !ref["type"].isNull()) {
+                // If the dereference of the current pointer is an ascii
+                // character we might have a string in this address
+                if (ref["type"].toString().contains("ascii")) {
+                    Node &stringNode = this->node(addr);
+                    if (!stringNode.stringRead) {
+                        QByteArray buf = read(addr, 128);
+                        stringNode.string = QString(buf);
+                        // Indicate that the string is longer than the printed
+                        // value
+                        if (stringNode.string.size() == buf.size()) {
+                            stringNode.string += "...";
+                        }
+                        stringNode.stringRead = true;
+                    }
+                    json["string"] = stringNode.string;
+                }
+                json["ref"] = ref;
+            }
+        }
+    }
+
+    results.insert(key, json);
+    return json;
+}
@@ -0,0 +1,88 @@
+#ifndef TELESCOPE_H
+#define TELESCOPE_H
+
+#include "core/IaitoCommon.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QPair>
+
+class IaitoCore;
+
+/**
+ * @brief Telescoping of addresses behind IaitoCore::getAddrRefs(),
+ * getStack() and getRegisterRefs().
+ *
+ * What r2 knows about an address (its kind, map, section, flag, function,
+ * instruction and the pointer it holds) is looked up once and kept in a
+ * typed node until the next DebugSnapshot generation or a change of the
+ * flags and function names, so stack slots and registers pointing at the
+ * same targets share the lookups and the chains below them. A stack window
+ * can be read with a single IO call and the slots are then dereferenced
+ * from it.
+ *
+ * Every function has to be called with the core locked.
+ */
+class IAITO_EXPORT Telescope : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Telescope(IaitoCore *core);
+
+    /**
+     * @brief Start a batch of lookups, forget everything if the debug stop
+     * changed since the last one
+     */
+    void begin(RCore *core, quint64 generation);
+
+    /**
+     * @brief Use window as the memory at base until the next generation
+     */
+    void setWindow(RVA base, const QByteArray &window);
+
+    /**
+     * @brief Telescoped references of addr, in the format of
+     * IaitoCore::getAddrRefs()
+     */
+    QJsonObject refs(RVA addr, int depth);
+
+public slots:
+    /**
+     * @brief Forget everything on the next begin(), even in the same
+     * generation
+     */
+    void invalidate();
+
+private:
+    struct Node
+    {
+        ut64 type = 0;
+        QString mapName;
+        QString section;
+        QString reg;
+        QString function;
+        QString instruction;
+        // pointer sized value at the address, read when it is readable data
+        bool hasValue = false;
+        ut64 value = 0;
+        bool stringRead = false;
+        QString string;
+    };
+
+    RCore *core = nullptr;
+    quint64 generation = 0;
+    bool outdated = false;
+    int bits = 64;
+    QHash<RVA, Node> nodes;
+    QHash<QPair<RVA, int>, QJsonObject> results;
+    RVA windowBase = 0;
+    QByteArray window;
+
+    Node &node(RVA addr);
+    QByteArray read(RVA addr, int size);
+};
+
+#endif // TELESCOPE_H
@@ -9,15 +9,25 @@
 #include <QVector>
 
 #include <cassert>
+#include <cmath>
 #include <memory>
 
 #include "Decompiler.h"
 #include "common/AsyncTask.h"
 #include "common/BasicInstructionHighlighter.h"
+#include "common/CommentCache.h"
+#include "common/DebugSnapshot.h"
+#include "common/DecompilerCache.h"
+#include "common/DecompilerPrefetcher.h"
 #include "common/Configuration.h"
+#include "common/DensityIndex.h"
+#include "common/DisassemblyTokenizer.h"
+#include "common/InstructionIndex.h"
 #include "common/Json.h"
+#include "common/MemoryPageCache.h"
 #include "common/R2Shims.h"
 #include "common/R2Task.h"
+#include "common/Telescope.h"
 #include "common/TempConfig.h"
 #include "core/Iaito.h"
 #include "plugins/PluginManager.h"
@@ -41,6 +51,7 @@ Q_GLOBAL_STATIC(IaitoCore, uniqueInstance)
 
 #define R_JSON_KEY(name) static const QString name = QStringLiteral(#name)
 #define CORE_LOCK() RCoreLocked core(this)
+#define CORE_READ_LOCK() RCoreReadLocked core(this)
 
 namespace RJsonKey {
 R_JSON_KEY(addr);
@@ -141,32 +152,44 @@ static QString fromOwnedCharPtr(char *str)
     return result;
 }
 
+#if R2_VERSION_NUMBER < 50609
+static void coreBedEnter(int &depth, void *&bed)
+{
+    assert(depth >= 0);
+    depth++;
+    if (depth == 1) {
+        if (bed) {
+            r_cons_sleep_end(bed);
+            bed = nullptr;
+        }
+    }
+}
+
+static void coreBedLeave(int &depth, void *&bed)
+{
+    depth--;
+    assert(depth >= 0);
+    if (depth == 0) {
+        bed = r_cons_sleep_begin();
+    }
+}
+#endif
+
 RCoreLocked::RCoreLocked(IaitoCore *core)
     : core(core)
 {
-    core->coreMutex.lock();
+    core->coreLock.lockExclusive();
 #if R2_VERSION_NUMBER < 50609
-    assert(core->coreLockDepth >= 0);
-    core->coreLockDepth++;
-    if (core->coreLockDepth == 1) {
-        if (core->coreBed) {
-            r_cons_sleep_end(core->coreBed);
-            core->coreBed = nullptr;
-        }
-    }
+    coreBedEnter(core->coreLockDepth, core->coreBed);
 #endif
 }
 
 RCoreLocked::~RCoreLocked()
 {
-    core->coreLockDepth--;
 #if R2_VERSION_NUMBER < 50609
-    assert(core->coreLockDepth >= 0);
-    if (core->coreLockDepth == 0) {
-        core->coreBed = r_cons_sleep_begin();
-    }
+    coreBedLeave(core->coreLockDepth, core->coreBed);
 #endif
-    core->coreMutex.unlock();
+    core->coreLock.unlockExclusive();
 }
 
 RCoreLocked::operator RCore *() const
@@ -179,6 +202,39 @@ RCore *RCoreLocked::operator->() const
     return core->core_;
 }
 
+RCoreReadLocked::RCoreReadLocked(IaitoCore *core)
+    : core(core)
+{
+#if R2_VERSION_NUMBER < 50609
+    // The task sleep bed can't be shared between threads, so older r2 versions
+    // get exclusive access for queries too
+    core->coreLock.lockExclusive();
+    coreBedEnter(core->coreLockDepth, core->coreBed);
+#else
+    core->coreLock.lockShared();
+#endif
+}
+
+RCoreReadLocked::~RCoreReadLocked()
+{
+#if R2_VERSION_NUMBER < 50609
+    coreBedLeave(core->coreLockDepth, core->coreBed);
+    core->coreLock.unlockExclusive();
+#else
+    core->coreLock.unlockShared();
+#endif
+}
+
+RCoreReadLocked::operator RCore *() const
+{
+    return core->core_;
+}
+
+RCore *RCoreReadLocked::operator->() const
+{
+    return core->core_;
+}
+
 static void cutterREventCallback(REvent *, int type, void *user, void *data)
 {
     auto core = reinterpret_cast<IaitoCore *>(user);
@@ -187,11 +243,6 @@ static void cutterREventCallback(REvent *, int type, void *user, void *data)
 
 IaitoCore::IaitoCore(QObject *parent)
     : QObject(parent)
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-    , coreMutex(QMutex::Recursive)
-#else
-    , coreMutex()
-#endif
 {}
 
 IaitoCore *IaitoCore::instance()
@@ -263,6 +314,16 @@ void IaitoCore::initialize(bool loadPlugins)
 
     // Initialize Async tasks manager
     asyncTaskManager = new AsyncTaskManager(this);
+
+    memoryPageCache = new MemoryPageCache(this);
+    instructionIndex = new InstructionIndex(this);
+    commentCache = new CommentCache(this);
+    densityIndex = new DensityIndex(this);
+    decompilerCache = new DecompilerCache(this);
+    decompilerPrefetcher = new DecompilerPrefetcher(this);
+    disassemblyTokenizer = new DisassemblyTokenizer(this);
+    debugSnapshot = new DebugSnapshot(this);
+    telescope = new Telescope(this);
 }
 
 IaitoCore::~IaitoCore()
@@ -287,6 +348,11 @@ RCoreLocked IaitoCore::core()
     return RCoreLocked(this);
 }
 
+RCoreReadLocked IaitoCore::coreRead()
+{
+    return RCoreReadLocked(this);
+}
+
 QDir IaitoCore::getIaitoRCDefaultDirectory() const
 {
     return QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
@@ -346,7 +412,7 @@ void IaitoCore::loadSecondaryIaitoRC()
 
 QList<QString> IaitoCore::sdbList(QString path)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     QList<QString> list = QList<QString>();
     Sdb *root = sdb_ns_path(core->sdb, path.toUtf8().constData(), 0);
     if (root) {
@@ -369,7 +435,7 @@ static SdbListPtr makeSdbListPtr(SdbList *list)
 
 QList<QString> IaitoCore::sdbListKeys(QString path)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     QList<QString> list = QList<QString>();
     Sdb *root = sdb_ns_path(core->sdb, path.toUtf8().constData(), 0);
     if (root) {
@@ -387,7 +453,7 @@ QList<QString> IaitoCore::sdbListKeys(QString path)
 
 QString IaitoCore::sdbGet(QString path, QString key)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     Sdb *db = sdb_ns_path(core->sdb, path.toUtf8().constData(), 0);
     if (db) {
         const char *val = sdb_const_get(db, key.toUtf8().constData(), 0);
@@ -786,6 +852,7 @@ void IaitoCore::renameFunctionVariable(QString newName, QString oldName, RVA fun
     if (variable) {
         r_anal_var_rename(variable, newName.toUtf8().constData(), true);
     }
+    decompilerCache->invalidate(functionAddress);
     emit refreshCodeViews();
 }
 
@@ -840,12 +907,15 @@ void IaitoCore::jmpReverse(RVA addr)
 void IaitoCore::editBytes(RVA addr, const QString &bytes)
 {
     cmdRawAt(QStringLiteral("wx %1").arg(bytes), addr);
+    // May be longer than the page the instructionChanged handler drops
+    memoryPageCache->invalidate(addr, (bytes.size() + 1) / 2);
     emit instructionChanged(addr);
 }
 
 void IaitoCore::editBytesEndian(RVA addr, const QString &bytes)
 {
     cmdRawAt(QStringLiteral("wv %1").arg(bytes), addr);
+    debugSnapshot->invalidate();
     emit stackChanged();
 }
 
@@ -941,7 +1011,7 @@ void IaitoCore::delComment(RVA addr)
  */
 QString IaitoCore::getCommentAt(RVA addr)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     return r_meta_get_string(core->anal, R_META_TYPE_COMMENT, addr);
 }
 
@@ -1041,36 +1111,12 @@ void IaitoCore::updateSeek()
 
 RVA IaitoCore::prevOpAddr(RVA startAddr, int count)
 {
-    CORE_LOCK();
-    bool ok;
-    RVA offset = cmdRawAt(QStringLiteral("/O %1").arg(count), startAddr).toULongLong(&ok, 16);
-    return ok ? offset : startAddr - count;
+    return instructionIndex->prev(startAddr, count);
 }
 
 RVA IaitoCore::nextOpAddr(RVA startAddr, int count)
 {
-    CORE_LOCK();
-
-    QJsonArray array
-        = Core()
-              ->cmdj("pdj " + QString::number(count + 1) + "@" + QString::number(startAddr))
-              .array();
-    if (array.isEmpty()) {
-        return startAddr + 1;
-    }
-
-    QJsonValue instValue = array.last();
-    if (!instValue.isObject()) {
-        return startAddr + 1;
-    }
-
-    bool ok;
-    RVA offset = instValue.toObject()[RJsonKey::offset].toVariant().toULongLong(&ok);
-    if (!ok) {
-        return startAddr + 1;
-    }
-
-    return offset;
+    return instructionIndex->next(startAddr, count);
 }
 
 RVA IaitoCore::getOffset()
@@ -1127,25 +1173,25 @@ void IaitoCore::setConfig(const char *k, bool v)
 
 int IaitoCore::getConfigi(const char *k)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     return static_cast<int>(r_config_get_i(core->config, k));
 }
 
 ut64 IaitoCore::getConfigut64(const char *k)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     return r_config_get_i(core->config, k);
 }
 
 bool IaitoCore::getConfigb(const char *k)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     return r_config_get_i(core->config, k) != 0;
 }
 
 QString IaitoCore::getConfigDescription(const char *k)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RConfigNode *node = r_config_node_get(core->config, k);
     return node ? QString(node->desc) : QStringLiteral("Unrecognized configuration key");
 }
@@ -1189,7 +1235,7 @@ QString IaitoCore::getFilePath()
 
 QString IaitoCore::getConfig(const char *k)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     return QString(r_config_get(core->config, k));
 }
 
@@ -1270,7 +1316,7 @@ QString IaitoCore::disassembleSingleInstruction(RVA addr)
 
 RAnalFunction *IaitoCore::functionIn(ut64 addr)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RList *fcns = r_anal_get_functions_in(core->anal, addr);
     RAnalFunction *fcn = !r_list_empty(fcns) ? reinterpret_cast<RAnalFunction *>(r_list_first(fcns))
                                              : nullptr;
@@ -1280,7 +1326,7 @@ RAnalFunction *IaitoCore::functionIn(ut64 addr)
 
 RAnalFunction *IaitoCore::functionAt(ut64 addr)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     return r_anal_get_function_at(core->anal, addr);
 }
 
@@ -1292,7 +1338,7 @@ RAnalFunction *IaitoCore::functionAt(ut64 addr)
  */
 RVA IaitoCore::getFunctionStart(RVA addr)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RAnalFunction *fcn = Core()->functionIn(addr);
     return fcn ? fcn->addr : RVA_INVALID;
 }
@@ -1305,7 +1351,7 @@ RVA IaitoCore::getFunctionStart(RVA addr)
  */
 RVA IaitoCore::getFunctionEnd(RVA addr)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RAnalFunction *fcn = Core()->functionIn(addr);
     return fcn ? fcn->addr : RVA_INVALID;
 }
@@ -1318,7 +1364,7 @@ RVA IaitoCore::getFunctionEnd(RVA addr)
  */
 RVA IaitoCore::getLastFunctionInstruction(RVA addr)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RAnalFunction *fcn = Core()->functionIn(addr);
     if (!fcn) {
         return RVA_INVALID;
@@ -1503,10 +1549,12 @@ QList<QJsonObject> IaitoCore::getRegisterRefs(int depth)
 
     QJsonObject registers = cmdj("drj").object();
 
+    CORE_LOCK();
+    telescope->begin(core, debugSnapshot->getGeneration());
     for (const QString &key : registers.keys()) {
         QJsonObject reg;
         reg["value"] = registers.value(key);
-        reg["ref"] = getAddrRefs(registers.value(key).toVariant().toULongLong(), depth);
+        reg["ref"] = telescope->refs(registers.value(key).toVariant().toULongLong(), depth);
         reg["name"] = key;
         ret.append(reg);
     }
@@ -1529,12 +1577,23 @@ QList<QJsonObject> IaitoCore::getStack(int size, int depth)
     }
 
     int base = r_config_get_i(core->config, "asm.bits");
+    if (base == 32 && addr < UT32_MAX) {
+        size = int(qMin(ut64(size), UT32_MAX - addr));
+    } else if (base == 16 && addr < UT16_MAX) {
+        size = int(qMin(ut64(size), UT16_MAX - addr));
+    }
+
+    // The whole window in one read, the slots are dereferenced from it
+    QByteArray window(size, 0);
+    ioReadAt(core, addr, reinterpret_cast<ut8 *>(window.data()), size);
+    telescope->begin(core, debugSnapshot->getGeneration());
+    telescope->setWindow(addr, window);
     for (int i = 0; i < size; i += base / 8) {
         if ((base == 32 && addr + i >= UT32_MAX) || (base == 16 && addr + i >= UT16_MAX)) {
             break;
         }
 
-        stack.append(getAddrRefs(addr + i, depth));
+        stack.append(telescope->refs(addr + i, depth));
     }
 
     return stack;
@@ -1542,134 +1601,9 @@ QList<QJsonObject> IaitoCore::getStack(int size, int depth)
 
 QJsonObject IaitoCore::getAddrRefs(RVA addr, int depth)
 {
-    QJsonObject json;
-    if (depth < 1 || addr == UT64_MAX) {
-        return json;
-    }
-
     CORE_LOCK();
-    int bits = r_config_get_i(core->config, "asm.bits");
-    QByteArray buf = QByteArray();
-    ut64 type = r_core_anal_address(core, addr);
-
-    json["addr"] = QString::number(addr);
-
-    // Search for the section the addr is in, avoid duplication for heap/stack
-    // with type
-    if (!(type & R_ANAL_ADDR_TYPE_HEAP || type & R_ANAL_ADDR_TYPE_STACK)) {
-        // Attempt to find the address within a map
-        RDebugMap *map = r_debug_map_get(core->dbg, addr);
-        if (map && map->name && map->name[0]) {
-            json["mapname"] = map->name;
-        }
-
-        RBinSection *sect = r_bin_get_section_at(r_bin_cur_object(core->bin), addr, true);
-        if (sect && sect->name[0]) {
-            json["section"] = sect->name;
-        }
-    }
-
-    // Check if the address points to a register
-    RFlagItem *fi = r_flag_get_i(core->flags, addr);
-    if (fi) {
-        RRegItem *r = r_reg_get(core->dbg->reg, fi->name, -1);
-        if (r) {
-            json["reg"] = r->name;
-#if R2_VERSION_NUMBER >= 50709
-            r_unref(r);
-#endif
-        }
-    }
-
-    // Attempt to find the address within a function
-    RAnalFunction *fcn = r_anal_get_fcn_in(core->anal, addr, 0);
-    if (fcn) {
-        json["fcn"] = fcn->name;
-    }
-
-    // Update type and permission information
-    if (type != 0) {
-        if (type & R_ANAL_ADDR_TYPE_HEAP) {
-            json["type"] = "heap";
-        } else if (type & R_ANAL_ADDR_TYPE_STACK) {
-            json["type"] = "stack";
-        } else if (type & R_ANAL_ADDR_TYPE_PROGRAM) {
-            json["type"] = "program";
-        } else if (type & R_ANAL_ADDR_TYPE_LIBRARY) {
-            json["type"] = "library";
-        } else if (type & R_ANAL_ADDR_TYPE_ASCII) {
-            json["type"] = "ascii";
-        } else if (type & R_ANAL_ADDR_TYPE_SEQUENCE) {
-            json["type"] = "sequence";
-        }
-
-        QString perms = "";
-        if (type & R_ANAL_ADDR_TYPE_READ) {
-            perms += "r";
-        }
-        if (type & R_ANAL_ADDR_TYPE_WRITE) {
-            perms += "w";
-        }
-        if (type & R_ANAL_ADDR_TYPE_EXEC) {
-#if R2_VERSION_NUMBER >= 50709
-            RAnalOp op;
-            buf.resize(32);
-            perms += "x";
-            // Instruction disassembly
-            r_io_read_at(core->io, addr, (unsigned char *) buf.data(), buf.size());
-            r_asm_set_pc(core->rasm, addr);
-            r_anal_op_init(&op);
-            r_asm_disassemble(core->rasm, &op, (unsigned char *) buf.data(), buf.size());
-            json["asm"] = op.mnemonic;
-            r_anal_op_fini(&op);
-#else
-            RAsmOp op;
-            buf.resize(32);
-            perms += "x";
-            // Instruction disassembly
-            r_io_read_at(core->io, addr, (unsigned char *) buf.data(), buf.size());
-            r_asm_set_pc(core->rasm, addr);
-            r_asm_disassemble(core->rasm, &op, (unsigned char *) buf.data(), buf.size());
-            json["asm"] = r_asm_op_get_asm(&op);
-#endif
-        }
-
-        if (!perms.isEmpty()) {
-            json["perms"] = perms;
-        }
-    }
-
-    // Try to telescope further if depth permits it
-    if ((type & R_ANAL_ADDR_TYPE_READ) && !(type & R_ANAL_ADDR_TYPE_EXEC)) {
-        buf.resize(64);
-        ut32 *n32 = (ut32 *) buf.data();
-        ut64 *n64 = (ut64 *) buf.data();
-        r_io_read_at(core->io, addr, (unsigned char *) buf.data(), buf.size());
-        ut64 n = (bits == 64) ? *n64 : *n32;
-        // The value of the next address will serve as an indication that
-        // there's more to telescope if we have reached the depth limit
-        json["value"] = QString::number(n);
-        if (depth && n != addr) {
-            // Make sure we aren't telescoping the same address
-            QJsonObject ref = getAddrRefs(n, depth - 1);
-            if (!ref.empty() && !ref["type"].isNull()) {
-                // If the dereference of the current pointer is an ascii
-                // character we might have a string in this address
-                if (ref["type"].toString().contains("ascii")) {
-                    buf.resize(128);
-                    r_io_read_at(core->io, addr, (unsigned char *) buf.data(), buf.size());
-                    QString strVal = QString(buf);
-                    // Indicate that the string is longer than the printed value
-                    if (strVal.size() == buf.size()) {
-                        strVal += "...";
-                    }
-                    json["string"] = strVal;
-                }
-                json["ref"] = ref;
-            }
-        }
-    }
-    return json;
+    telescope->begin(core, debugSnapshot->getGeneration());
+    return telescope->refs(addr, depth);
 }
 
 QJsonDocument IaitoCore::getProcessThreads(int pid)
@@ -1760,6 +1694,7 @@ RVA IaitoCore::getProgramCounterValue()
 void IaitoCore::setRegister(QString regName, QString regValue)
 {
     cmdRaw(QStringLiteral("dr %1=%2").arg(regName).arg(regValue));
+    debugSnapshot->invalidate();
     emit registersChanged();
     emit refreshCodeViews();
 }
@@ -1773,9 +1708,8 @@ void IaitoCore::setCurrentDebugThread(int tid)
     emit debugTaskStateChanged();
     connect(debugTask.data(), &R2Task::finished, this, [this]() {
         debugTask.clear();
-        emit registersChanged();
+        debugSnapshot->invalidate();
         emit refreshCodeViews();
-        emit stackChanged();
         syncAndSeekProgramCounter();
         emit switchedThread();
         emit debugTaskStateChanged();
@@ -1793,9 +1727,8 @@ void IaitoCore::setCurrentDebugProcess(int pid)
     emit debugTaskStateChanged();
     connect(debugTask.data(), &R2Task::finished, this, [this]() {
         debugTask.clear();
-        emit registersChanged();
+        debugSnapshot->invalidate();
         emit refreshCodeViews();
-        emit stackChanged();
         emit flagsChanged();
         syncAndSeekProgramCounter();
         emit switchedProcess();
@@ -1824,7 +1757,6 @@ void IaitoCore::startDebug()
         }
         debugTask.clear();
 
-        emit registersChanged();
         if (!currentlyDebugging) {
             setConfig("asm.flags", false);
             currentlyDebugging = true;
@@ -1832,8 +1764,9 @@ void IaitoCore::startDebug()
             emit refreshCodeViews();
         }
 
+        debugSnapshot->invalidate();
+        emit registersChanged();
         emit codeRebased();
-        emit stackChanged();
         emit debugTaskStateChanged();
     });
 
@@ -1874,8 +1807,8 @@ void IaitoCore::startEmulation()
             emit toggleDebugView();
         }
 
+        debugSnapshot->invalidate();
         emit registersChanged();
-        emit stackChanged();
         emit codeRebased();
         emit refreshCodeViews();
         emit debugTaskStateChanged();
@@ -1922,7 +1855,6 @@ void IaitoCore::attachRemote(const QString &uri)
             return;
         }
 
-        emit registersChanged();
         if (!currentlyDebugging || !currentlyEmulating) {
             // prevent register flags from appearing during debug/emul
             setConfig("asm.flags", false);
@@ -1930,6 +1862,8 @@ void IaitoCore::attachRemote(const QString &uri)
             emit toggleDebugView();
         }
 
+        debugSnapshot->invalidate();
+        emit registersChanged();
         emit codeRebased();
         emit attachedRemote(true);
         emit debugTaskStateChanged();
@@ -1959,6 +1893,7 @@ void IaitoCore::attachDebug(int pid)
             delete debugTaskDialog;
         }
         debugTask.clear();
+        debugSnapshot->invalidate();
 
         syncAndSeekProgramCounter();
         if (!currentlyDebugging || !currentlyEmulating) {
@@ -2024,6 +1959,7 @@ void IaitoCore::stopDebug()
         cmd("doc" + ptraceFiles);
     }
 
+    debugSnapshot->invalidate();
     syncAndSeekProgramCounter();
     setConfig("asm.flags", true);
     setConfig("io.cache", false);
@@ -2058,8 +1994,8 @@ void IaitoCore::continueDebug()
     emit debugTaskStateChanged();
     connect(debugTask.data(), &R2Task::finished, this, [this]() {
         debugTask.clear();
+        debugSnapshot->invalidate();
         syncAndSeekProgramCounter();
-        emit registersChanged();
         emit refreshCodeViews();
         emit debugTaskStateChanged();
     });
@@ -2086,9 +2022,8 @@ void IaitoCore::continueUntilDebug(QString offset)
     emit debugTaskStateChanged();
     connect(debugTask.data(), &R2Task::finished, this, [this]() {
         debugTask.clear();
+        debugSnapshot->invalidate();
         syncAndSeekProgramCounter();
-        emit registersChanged();
-        emit stackChanged();
         emit refreshCodeViews();
         emit debugTaskStateChanged();
     });
@@ -2115,6 +2050,7 @@ void IaitoCore::continueUntilCall()
     emit debugTaskStateChanged();
     connect(debugTask.data(), &R2Task::finished, this, [this]() {
         debugTask.clear();
+        debugSnapshot->invalidate();
         syncAndSeekProgramCounter();
         emit debugTaskStateChanged();
     });
@@ -2141,6 +2077,7 @@ void IaitoCore::continueUntilSyscall()
     emit debugTaskStateChanged();
     connect(debugTask.data(), &R2Task::finished, this, [this]() {
         debugTask.clear();
+        debugSnapshot->invalidate();
         syncAndSeekProgramCounter();
         emit debugTaskStateChanged();
     });
@@ -2167,6 +2104,7 @@ void IaitoCore::stepDebug()
     emit debugTaskStateChanged();
     connect(debugTask.data(), &R2Task::finished, this, [this]() {
         debugTask.clear();
+        debugSnapshot->invalidate();
         syncAndSeekProgramCounter();
         emit debugTaskStateChanged();
     });
@@ -2193,6 +2131,7 @@ void IaitoCore::stepOverDebug()
     emit debugTaskStateChanged();
     connect(debugTask.data(), &R2Task::finished, this, [this]() {
         debugTask.clear();
+        debugSnapshot->invalidate();
         syncAndSeekProgramCounter();
         emit debugTaskStateChanged();
     });
@@ -2213,6 +2152,7 @@ void IaitoCore::stepOutDebug()
 
     connect(debugTask.data(), &R2Task::finished, this, [this]() {
         debugTask.clear();
+        debugSnapshot->invalidate();
         syncAndSeekProgramCounter();
         emit debugTaskStateChanged();
     });
@@ -2379,13 +2319,13 @@ static BreakpointDescription breakpointDescriptionFromR2(int index, r_bp_item_t
 
 int IaitoCore::breakpointIndexAt(RVA addr)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     return r_bp_get_index_at(core->dbg->bp, addr);
 }
 
 BreakpointDescription IaitoCore::getBreakpointAt(RVA addr)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     int index = breakpointIndexAt(addr);
     auto bp = r_bp_get_index(core->dbg->bp, index);
     if (bp) {
@@ -2396,7 +2336,7 @@ BreakpointDescription IaitoCore::getBreakpointAt(RVA addr)
 
 QList<BreakpointDescription> IaitoCore::getBreakpoints()
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     QList<BreakpointDescription> ret;
     for (int i = 0; i < core->dbg->bp->bps_idx_count; i++) {
         RBreakpointItem *bpi = r_bp_get_index(core->dbg->bp, i);
@@ -2566,7 +2506,7 @@ QList<RVA> IaitoCore::getSeekHistory()
 
 QStringList IaitoCore::getAsmPluginNames()
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RListIter *it;
     QStringList ret;
 
@@ -2595,7 +2535,7 @@ QStringList IaitoCore::getAsmPluginNames()
 
 QStringList IaitoCore::getAnalPluginNames()
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RListIter *it;
     QStringList ret;
 
@@ -2705,7 +2645,7 @@ QList<RCorePluginDescription> IaitoCore::getRCorePluginDescriptions()
 
 QList<RAsmPluginDescription> IaitoCore::getRAsmPluginDescriptions()
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RListIter *it;
     QList<RAsmPluginDescription> ret;
 
@@ -2766,7 +2706,7 @@ QList<RAsmPluginDescription> IaitoCore::getRAsmPluginDescriptions()
 
 QList<RAsmPluginDescription> IaitoCore::getRAnalPluginDescriptions()
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RListIter *it;
     QList<RAsmPluginDescription> ret;
 
@@ -2798,7 +2738,7 @@ QList<RAsmPluginDescription> IaitoCore::getRAnalPluginDescriptions()
 
 QList<FunctionDescription> IaitoCore::getAllFunctions()
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
 
     QList<FunctionDescription> funcList;
     funcList.reserve(r_list_length(core->anal->fcns));
@@ -2830,7 +2770,7 @@ QList<FunctionDescription> IaitoCore::getAllFunctions()
 
 QList<ImportDescription> IaitoCore::getAllImports()
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     QList<ImportDescription> ret;
 
 #if 0
@@ -2911,7 +2851,7 @@ QList<ExportDescription> IaitoCore::getAllExports()
 
 QList<SymbolDescription> IaitoCore::getAllSymbols()
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RListIter *it;
 
     QList<SymbolDescription> ret;
@@ -3002,20 +2942,24 @@ QList<ZignatureDescription> IaitoCore::getAllZignatures()
 
 QList<CommentDescription> IaitoCore::getAllComments(const QString &filterType)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     QList<CommentDescription> ret;
 
-    QJsonArray commentsArray = cmdj("CCj").array();
-    for (const QJsonValue value : commentsArray) {
-        QJsonObject commentObject = value.toObject();
-
-        QString type = commentObject[RJsonKey::type].toString();
-        if (type != filterType)
+    if (!core->anal->meta.root) {
+        return ret;
+    }
+    const QByteArray type = filterType.toUtf8();
+    RIntervalTreeIter it = r_rbtree_first(&core->anal->meta.root->node);
+    for (; r_rbtree_iter_has(&it); r_rbtree_iter_next(&it)) {
+        RIntervalNode *node = r_interval_tree_iter_get(&it);
+        auto item = reinterpret_cast<RAnalMetaItem *>(node->data);
+        if (!item || type != r_meta_type_tostring(item->type)) {
             continue;
+        }
 
         CommentDescription comment;
-        comment.offset = commentObject[RJsonKey::offset].toVariant().toULongLong();
-        comment.name = commentObject[RJsonKey::name].toString();
+        comment.offset = node->start;
+        comment.name = QString::fromUtf8(item->str);
 
         ret << comment;
     }
@@ -3024,7 +2968,7 @@ QList<CommentDescription> IaitoCore::getAllComments(const QString &filterType)
 
 QList<RelocDescription> IaitoCore::getAllRelocs()
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     QList<RelocDescription> ret;
 
     if (core && core->bin && core->bin->cur && core->bin->cur->BO) {
@@ -3094,9 +3038,51 @@ QList<RelocDescription> IaitoCore::getAllRelocs()
 
 QList<StringDescription> IaitoCore::getAllStrings()
 {
+    {
+        // Exclusive, the scan moves the seek of the shared RBin buffer
+        CORE_LOCK();
+        RBinFile *bf = r_bin_cur(core->bin);
+        if (bf) {
+            RList *strings = r_bin_dump_strings(bf, 0, 2);
+            QList<StringDescription> ret = stringsFromRList(core, strings);
+            r_list_free(strings);
+            return ret;
+        }
+    }
+    // No RBin file to scan natively, let r2 handle it
     return parseStringsJson(cmdjTask("izzj"));
 }
 
+QList<StringDescription> IaitoCore::stringsFromRList(RCore *core, const RList *strings)
+{
+    QList<StringDescription> ret;
+    if (!strings) {
+        return ret;
+    }
+    ret.reserve(r_list_length(strings));
+
+    RBinObject *bo = r_bin_cur_object(core->bin);
+    RListIter *it;
+    RBinString *bs;
+    IaitoRListForeach(strings, it, RBinString, bs)
+    {
+        StringDescription string;
+
+        string.string = QString::fromUtf8(bs->string);
+        string.vaddr = bs->vaddr;
+        string.type = QString::fromUtf8(r_bin_string_type(bs->type));
+        string.size = bs->size;
+        string.length = bs->length;
+        RBinSection *section = bo ? r_bin_get_section_at(bo, bs->paddr, false) : nullptr;
+        if (section && section->name) {
+            string.section = QString::fromUtf8(section->name);
+        }
+
+        ret << string;
+    }
+    return ret;
+}
+
 QList<StringDescription> IaitoCore::parseStringsJson(const QJsonDocument &doc)
 {
     QList<StringDescription> ret;
@@ -3138,34 +3124,96 @@ QList<FlagspaceDescription> IaitoCore::getAllFlagspaces()
     return ret;
 }
 
-QList<FlagDescription> IaitoCore::getAllFlags(QString flagspace)
+static bool collectFlagCallback(RFlagItem *fi, void *user)
 {
-    CORE_LOCK();
-    QList<FlagDescription> ret;
+    auto flags = reinterpret_cast<QList<FlagDescription> *>(user);
 
-    if (!flagspace.isEmpty())
-        cmdRaw("fs " + flagspace);
-    else
-        cmdRaw("fs *");
+    FlagDescription flag;
+    flag.offset = ADDRESS_OF(fi);
+    flag.size = fi->size;
+    flag.name = QString::fromUtf8(fi->name);
+    flag.realname = fi->realname ? QString::fromUtf8(fi->realname) : flag.name;
 
-    QJsonArray flagsArray = cmdj("fj").array();
-    for (const QJsonValue value : flagsArray) {
-        QJsonObject flagObject = value.toObject();
-
-        FlagDescription flag;
+    flags->append(flag);
+    return true;
+}
 
-        flag.offset = flagObject[RJsonKey::offset].toVariant().toULongLong();
-        flag.size = flagObject[RJsonKey::size].toVariant().toULongLong();
-        flag.name = flagObject[RJsonKey::name].toString();
-        flag.realname = flagObject[RJsonKey::realname].toString();
+QList<FlagDescription> IaitoCore::getAllFlags(QString flagspace)
+{
+    CORE_READ_LOCK();
+    QList<FlagDescription> ret;
 
-        ret << flag;
+    if (flagspace.isEmpty()) {
+        r_flag_foreach(core->flags, collectFlagCallback, &ret);
+    } else {
+        const RSpace *space = r_flag_space_get(core->flags, flagspace.toUtf8().constData());
+        if (space) {
+            r_flag_foreach_space(core->flags, space, collectFlagCallback, &ret);
+        }
     }
     return ret;
 }
 
+/**
+ * @brief Shannon entropy of the bytes in [addr, addr + size), read in chunks
+ */
+static double ioEntropy(RCore *core, ut64 addr, ut64 size)
+{
+    if (!size) {
+        return 0.0;
+    }
+    const ut64 chunkSize = 1024 * 1024;
+    QVector<ut64> histogram(256, 0);
+    QByteArray buf(static_cast<int>(qMin(size, chunkSize)), 0);
+    for (ut64 done = 0; done < size;) {
+        int len = static_cast<int>(qMin(size - done, chunkSize));
+        auto data = reinterpret_cast<ut8 *>(buf.data());
+        Core()->ioReadAt(core, addr + done, data, len);
+        for (int i = 0; i < len; i++) {
+            histogram[data[i]]++;
+        }
+        done += len;
+    }
+    double entropy = 0.0;
+    for (ut64 count : histogram) {
+        if (count) {
+            double p = static_cast<double>(count) / size;
+            entropy -= p * std::log2(p);
+        }
+    }
+    return entropy;
+}
+
 QList<SectionDescription> IaitoCore::getAllSections()
 {
+    {
+        CORE_READ_LOCK();
+        const RList *list = r_bin_get_sections(core->bin);
+        if (list) {
+            QList<SectionDescription> sections;
+            RListIter *it;
+            RBinSection *sect;
+            IaitoRListForeach(list, it, RBinSection, sect)
+            {
+                if (sect->is_segment || !sect->name || !*sect->name) {
+                    continue;
+                }
+
+                SectionDescription section;
+                section.name = QString::fromUtf8(sect->name);
+                section.vaddr = sect->vaddr;
+                section.vsize = sect->vsize;
+                section.paddr = sect->paddr;
+                section.size = sect->size;
+                section.perm = QString::fromUtf8(r_str_rwx_i(sect->perm));
+                section.entropy = QString::number(ioEntropy(core, sect->vaddr, sect->size), 'f', 8);
+
+                sections << section;
+            }
+            return sections;
+        }
+    }
+
     CORE_LOCK();
     QList<SectionDescription> sections;
 
@@ -3208,6 +3256,33 @@ QStringList IaitoCore::getSectionList()
 
 QList<SegmentDescription> IaitoCore::getAllSegments()
 {
+    {
+        CORE_READ_LOCK();
+        const RList *list = r_bin_get_sections(core->bin);
+        if (list) {
+            QList<SegmentDescription> ret;
+            RListIter *it;
+            RBinSection *sect;
+            IaitoRListForeach(list, it, RBinSection, sect)
+            {
+                if (!sect->is_segment || !sect->name || !*sect->name) {
+                    continue;
+                }
+
+                SegmentDescription segment;
+                segment.name = QString::fromUtf8(sect->name);
+                segment.vaddr = sect->vaddr;
+                segment.paddr = sect->paddr;
+                segment.size = sect->size;
+                segment.vsize = sect->vsize;
+                segment.perm = QString::fromUtf8(r_str_rwx_i(sect->perm));
+
+                ret << segment;
+            }
+            return ret;
+        }
+    }
+
     CORE_LOCK();
     QList<SegmentDescription> ret;
 
@@ -3363,7 +3438,7 @@ QList<BinClassDescription> IaitoCore::getAllClassesFromFlags()
 
 QList<QString> IaitoCore::getAllAnalClasses(bool sorted)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     QList<QString> ret;
 
     SdbListPtr l = makeSdbListPtr(r_anal_class_get_all(core->anal, sorted));
@@ -3385,7 +3460,7 @@ QList<QString> IaitoCore::getAllAnalClasses(bool sorted)
 
 QList<AnalMethodDescription> IaitoCore::getAnalClassMethods(const QString &cls)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     QList<AnalMethodDescription> ret;
 
     RVector *meths = r_anal_class_method_get_all(core->anal, cls.toUtf8().constData());
@@ -3410,7 +3485,7 @@ QList<AnalMethodDescription> IaitoCore::getAnalClassMethods(const QString &cls)
 
 QList<AnalBaseClassDescription> IaitoCore::getAnalClassBaseClasses(const QString &cls)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     QList<AnalBaseClassDescription> ret;
 
     RVector *bases = r_anal_class_base_get_all(core->anal, cls.toUtf8().constData());
@@ -3435,7 +3510,7 @@ QList<AnalBaseClassDescription> IaitoCore::getAnalClassBaseClasses(const QString
 
 QList<AnalVTableDescription> IaitoCore::getAnalClassVTables(const QString &cls)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     QList<AnalVTableDescription> acVtables;
 
     RVector *vtables = r_anal_class_vtable_get_all(core->anal, cls.toUtf8().constData());
@@ -3478,7 +3553,7 @@ void IaitoCore::deleteClass(const QString &cls)
 
 bool IaitoCore::getAnalMethod(const QString &cls, const QString &meth, AnalMethodDescription *desc)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     RAnalMethod analMeth;
     if (r_anal_class_method_get(
             core->anal, cls.toUtf8().constData(), meth.toUtf8().constData(), &analMeth)
@@ -3735,28 +3810,34 @@ bool IaitoCore::isAddressMapped(RVA addr)
 QList<SearchDescription> IaitoCore::getAllSearch(QString search_for, QString space)
 {
     CORE_LOCK();
+    return parseSearchJson(space, cmdj(space + QStringLiteral(" ") + search_for));
+}
+
+QList<SearchDescription> IaitoCore::parseSearchJson(const QString &space, const QJsonDocument &doc)
+{
     QList<SearchDescription> searchRef;
 
-    QJsonArray searchArray = cmdj(space + QStringLiteral(" ") + search_for).array();
+    QJsonArray searchArray = doc.array();
+    searchRef.reserve(searchArray.size());
 
     if (space == "/Rj") {
         for (const QJsonValue value : searchArray) {
             QJsonObject searchObject = value.toObject();
+            QJsonArray opcodes = searchObject[RJsonKey::opcodes].toArray();
 
             SearchDescription exp;
 
-            exp.code.clear();
-            for (const QJsonValue value2 : searchObject[RJsonKey::opcodes].toArray()) {
-                QJsonObject gadget = value2.toObject();
-                exp.code += gadget[RJsonKey::opcode].toString() + ";  ";
+            QStringList gadgets;
+            gadgets.reserve(opcodes.size());
+            for (const QJsonValue value2 : opcodes) {
+                gadgets << value2.toObject()[RJsonKey::opcode].toString();
+            }
+            exp.code = gadgets.join(QStringLiteral(";  "));
+            if (!gadgets.isEmpty()) {
+                exp.code += QStringLiteral(";  ");
             }
 
-            exp.offset = searchObject[RJsonKey::opcodes]
-                             .toArray()
-                             .first()
-                             .toObject()[RJsonKey::offset]
-                             .toVariant()
-                             .toULongLong();
+            exp.offset = opcodes.first().toObject()[RJsonKey::offset].toVariant().toULongLong();
             exp.size = searchObject[RJsonKey::size].toVariant().toULongLong();
 
             searchRef << exp;
@@ -3779,6 +3860,19 @@ QList<SearchDescription> IaitoCore::getAllSearch(QString search_for, QString spa
 }
 
 BlockStatistics IaitoCore::getBlockStatistics(unsigned int blocksCount)
+{
+    BlockStatistics blockStats;
+    if (blocksCount == 0) {
+        blockStats.from = blockStats.to = blockStats.blocksize = 0;
+        return blockStats;
+    }
+    if (densityIndex->statistics(blocksCount, blockStats)) {
+        return blockStats;
+    }
+    return getBlockStatisticsJson(blocksCount);
+}
+
+BlockStatistics IaitoCore::getBlockStatisticsJson(unsigned int blocksCount)
 {
     BlockStatistics blockStats;
     if (blocksCount == 0) {
@@ -3869,10 +3963,50 @@ QList<XrefDescription> IaitoCore::getXRefsForVariable(
 }
 
 QList<XrefDescription> IaitoCore::getXRefs(
-    RVA addr, bool to, bool whole_function, const QString &filterType)
+    RVA addr, bool to, bool whole_function, const QString &filterType, bool resolveNames)
 {
     QList<XrefDescription> xrefList = QList<XrefDescription>();
 
+#if R2_VERSION_NUMBER >= 50809
+    {
+        CORE_READ_LOCK();
+        RVecAnalRef *refs = nullptr;
+        if (to) {
+            refs = r_anal_xrefs_get(core->anal, addr);
+        } else {
+            RAnalFunction *fcn = r_anal_get_fcn_in(core->anal, addr, 0);
+            refs = fcn ? r_anal_function_get_refs(fcn) : r_anal_refs_get(core->anal, addr);
+        }
+        if (refs) {
+            RAnalRef *ref;
+            R_VEC_FOREACH(refs, ref)
+            {
+                XrefDescription xref;
+
+                xref.type = QString::fromUtf8(r_anal_ref_type_tostring(ref->type));
+
+                if (!filterType.isNull() && filterType != xref.type)
+                    continue;
+
+                xref.from = ref->at;
+                if (!whole_function && !to && xref.from != addr) {
+                    continue;
+                }
+                RAnalFunction *fcn = to ? r_anal_get_fcn_in(core->anal, xref.from, 0) : nullptr;
+                if (fcn && fcn->name) {
+                    xref.from_str = QString::fromUtf8(fcn->name) + " + 0x"
+                                    + QString::number(xref.from - fcn->addr, 16);
+                } else {
+                    xref.from_str = RAddressString(xref.from);
+                }
+                xref.to = ref->addr;
+
+                xrefList << xref;
+            }
+            RVecAnalRef_free(refs);
+        }
+    }
+#else
     QJsonArray xrefsArray;
 
     if (to) {
@@ -3913,10 +4047,22 @@ QList<XrefDescription> IaitoCore::getXRefs(
         } else {
             xref.to = xrefObject[RJsonKey::to].toVariant().toULongLong();
         }
-        xref.to_str = Core()->cmdRaw(QStringLiteral("fd %1").arg(xref.to)).trimmed();
 
         xrefList << xref;
     }
+#endif
+
+    if (resolveNames) {
+        QList<RVA> targets;
+        targets.reserve(xrefList.size());
+        for (const XrefDescription &xref : xrefList) {
+            targets << xref.to;
+        }
+        const QHash<RVA, QString> names = getNearestFlagNames(targets);
+        for (XrefDescription &xref : xrefList) {
+            xref.to_str = names.value(xref.to);
+        }
+    }
 
     return xrefList;
 }
@@ -3963,7 +4109,7 @@ void IaitoCore::addFlag(RVA offset, QString name, RVA size, QString color, QStri
  */
 QString IaitoCore::listFlagsAsStringAt(RVA addr)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
     char *flagList = r_flag_get_liststr(core->flags, addr);
     QString result = fromOwnedCharPtr(flagList);
     return result;
@@ -3980,6 +4126,30 @@ QString IaitoCore::nearestFlag(RVA offset, RVA *flagOffsetOut)
     return name;
 }
 
+QHash<RVA, QString> IaitoCore::getNearestFlagNames(const QList<RVA> &addrs)
+{
+    CORE_READ_LOCK();
+    QHash<RVA, QString> names;
+    names.reserve(addrs.size());
+
+    for (RVA addr : addrs) {
+        if (names.contains(addr)) {
+            continue;
+        }
+        QString name;
+        RFlagItem *fi = r_flag_get_at(core->flags, addr, true);
+        if (fi) {
+            RVA flagAddr = ADDRESS_OF(fi);
+            name = QString::fromUtf8(fi->name);
+            if (flagAddr != addr) {
+                name += QStringLiteral(" + %1").arg(addr - flagAddr);
+            }
+        }
+        names.insert(addr, name);
+    }
+    return names;
+}
+
 void IaitoCore::handleREvent(int type, void *data)
 {
     switch (type) {
@@ -4100,7 +4270,7 @@ QList<DisassemblyLine> IaitoCore::disassembleLines(RVA offset, int lines)
         QJsonObject object = value.toObject();
         DisassemblyLine line;
         line.offset = object[RJsonKey::offset].toVariant().toULongLong();
-        line.text = ansiEscapeToHtml(object[RJsonKey::text].toString());
+        line.text = disassemblyTokenizer->tokenize(object[RJsonKey::text].toString());
 
         const auto &arrow = object[RJsonKey::arrow];
         line.arrow = arrow.isNull() ? RVA_INVALID : arrow.toVariant().toULongLong();
@@ -4341,7 +4511,7 @@ QStringList IaitoCore::getDisassemblyPreview(RVA address, int num_of_lines)
     }
     QStringList disasmPreview;
     for (const DisassemblyLine &line : disassemblyLines) {
-        disasmPreview << line.text;
+        disasmPreview << DisassemblyTokenizer::html(line.text);
         if (disasmPreview.length() >= num_of_lines) {
             disasmPreview << "...";
             break;
@@ -4374,7 +4544,7 @@ QString IaitoCore::getHexdumpPreview(RVA address, int size)
 
 QByteArray IaitoCore::ioRead(RVA addr, int len)
 {
-    CORE_LOCK();
+    CORE_READ_LOCK();
 
     QByteArray array;
 
@@ -4383,10 +4553,16 @@ QByteArray IaitoCore::ioRead(RVA addr, int len)
 
     /* Zero-copy */
     array.resize(len);
-    if (!r_io_read_at(core->io, addr, (uint8_t *) array.data(), len)) {
+    if (!ioReadAt(core, addr, (uint8_t *) array.data(), len)) {
         qWarning() << "Can't read data" << addr << len;
         array.fill(0xff);
     }
 
     return array;
 }
+
+bool IaitoCore::ioReadAt(RCore *core, RVA addr, ut8 *buf, int len)
+{
+    QMutexLocker locker(&ioMutex);
+    return r_io_read_at(core->io, addr, buf, len);
+}
@@ -6,11 +6,13 @@
 
 #include "common/BasicInstructionHighlighter.h"
 #include "core/IaitoCommon.h"
+#include "core/IaitoCoreLock.h"
 #include "core/IaitoDescriptions.h"
 
 #include <QDebug>
 #include <QDir>
 #include <QErrorMessage>
+#include <QHash>
 #include <QJsonDocument>
 #include <QMap>
 #include <QMenu>
@@ -23,6 +25,15 @@ class AsyncTaskManager;
 class BasicInstructionHighlighter;
 class IaitoCore;
 class Decompiler;
+class MemoryPageCache;
+class InstructionIndex;
+class CommentCache;
+class DisassemblyTokenizer;
+class DebugSnapshot;
+class Telescope;
+class DecompilerCache;
+class DecompilerPrefetcher;
+class DensityIndex;
 class R2Task;
 class R2TaskDialog;
 
@@ -49,12 +60,14 @@ class R2TaskDialog;
 #endif
 
 class RCoreLocked;
+class RCoreReadLocked;
 
 class IAITO_EXPORT IaitoCore : public QObject
 {
     Q_OBJECT
 
     friend class RCoreLocked;
+    friend class RCoreReadLocked;
     friend class R2Task;
 
 public:
@@ -70,6 +83,38 @@ public:
     QDir getIaitoRCDefaultDirectory() const;
 
     AsyncTaskManager *getAsyncTaskManager() { return asyncTaskManager; }
+    /**
+     * @brief Cache of io pages used by the views reading raw memory
+     */
+    MemoryPageCache *getMemoryPageCache() { return memoryPageCache; }
+    /**
+     * @brief Instruction boundaries used by prevOpAddr() and nextOpAddr()
+     */
+    InstructionIndex *getInstructionIndex() { return instructionIndex; }
+    /**
+     * @brief Comments of the whole address space, for models showing a comment column
+     */
+    CommentCache *getCommentCache() { return commentCache; }
+    /**
+     * @brief Item counts over the address space behind getBlockStatistics()
+     */
+    DensityIndex *getDensityIndex() { return densityIndex; }
+    /**
+     * @brief Recently decompiled functions, shared by the decompiler widgets
+     */
+    DecompilerCache *getDecompilerCache() { return decompilerCache; }
+    /**
+     * @brief Background decompilation of the functions likely to be shown next
+     */
+    DecompilerPrefetcher *getDecompilerPrefetcher() { return decompilerPrefetcher; }
+    /**
+     * @brief Colored r2 output split into typed tokens, shared by the disassembly renderers
+     */
+    DisassemblyTokenizer *getDisassemblyTokenizer() { return disassemblyTokenizer; }
+    /**
+     * @brief Registers, stack, backtrace and maps at the current debug stop
+     */
+    DebugSnapshot *getDebugSnapshot() { return debugSnapshot; }
 
     RVA getOffset() const { return ADDRESS_OF (core_); }
 
@@ -240,6 +285,14 @@ public:
      * @return flag name
      */
     QString nearestFlag(RVA offset, RVA *flagOffsetOut);
+    /**
+     * @brief Describe many addresses by their nearest flag at once, like the
+     * "fd" command does for a single one ("name" or "name + delta").
+     * @param addrs addresses to resolve, duplicates are resolved once
+     * @return map from address to description, empty if there is no flag
+     * at or before the address
+     */
+    QHash<RVA, QString> getNearestFlagNames(const QList<RVA> &addrs);
     void triggerFlagsChanged();
 
     /* Edition functions */
@@ -419,7 +472,7 @@ public:
     QList<QJsonObject> getStack(int size = 0x100, int depth = 6);
     /**
      * @brief Recursively dereferences pointers starting at the specified
-     * address up to a given depth
+     * address up to a given depth, results are kept until the next debug stop
      * @param addr telescoping addr
      * @param depth telescoping depth
      */
@@ -531,6 +584,14 @@ public:
     void loadPDB(const QString &file);
 
     QByteArray ioRead(RVA addr, int len);
+    /**
+     * @brief r_io_read_at() for callers already holding the core
+     *
+     * RIO keeps the seek, the descriptors and the bank and map caches in
+     * shared state, so readers holding only the shared lock must not read at
+     * the same time. Every io read goes through here one at a time.
+     */
+    bool ioReadAt(RCore *core, RVA addr, ut8 *buf, int len);
 
     QList<RVA> getSeekHistory();
 
@@ -631,7 +692,21 @@ public:
 
     QList<MemoryMapDescription> getMemoryMap();
     QList<SearchDescription> getAllSearch(QString search_for, QString space);
+    /**
+     * @brief Parse the output of a json search command like /xj or /Rj
+     * @param space the search command, ROP gadgets are laid out differently
+     */
+    static QList<SearchDescription> parseSearchJson(const QString &space, const QJsonDocument &doc);
+    /**
+     * @brief Item counts over the sections split in at least blocksCount
+     * blocks, answered from the density index when there are sections
+     */
     BlockStatistics getBlockStatistics(unsigned int blocksCount);
+    /**
+     * @brief getBlockStatistics through the "p-j" command, used when there is
+     * no RBin information to compute the boundaries from.
+     */
+    BlockStatistics getBlockStatisticsJson(unsigned int blocksCount);
     QList<BreakpointDescription> getBreakpoints();
     QList<ProcessDescription> getAllProcesses();
     /**
@@ -655,10 +730,25 @@ public:
      * writes or reads that happen to the variable 'variableName'.
      */
     QList<XrefDescription> getXRefsForVariable(QString variableName, bool findWrites, RVA offset);
+    /**
+     * @brief Get the references to or from an address
+     * @param resolveNames fill XrefDescription::to_str with the nearest flag
+     * of each target. Pass false when the names are not needed or are
+     * resolved later through getNearestFlagNames().
+     */
     QList<XrefDescription> getXRefs(
-        RVA addr, bool to, bool whole_function, const QString &filterType = QString());
+        RVA addr,
+        bool to,
+        bool whole_function,
+        const QString &filterType = QString(),
+        bool resolveNames = true);
 
     QList<StringDescription> parseStringsJson(const QJsonDocument &doc);
+    /**
+     * @brief Convert a list of RBinString as returned by r_bin_dump_strings()
+     * @note the caller must hold the core lock
+     */
+    static QList<StringDescription> stringsFromRList(RCore *core, const RList *strings);
 
     void handleREvent(int type, void *data);
 
@@ -674,6 +764,12 @@ public:
     QStringList getSectionList();
 
     RCoreLocked core();
+    /**
+     * @brief Shared access to the RCore for pure queries through the native
+     * API. Many threads can hold it at the same time, so it must not be used
+     * to run commands or modify anything, use core() for that.
+     */
+    RCoreReadLocked coreRead();
 
     static QString ansiEscapeToHtml(const QString &text);
     BasicBlockHighlighter *getBBHighlighter();
@@ -783,18 +879,25 @@ private:
 
     /**
      * Internal reference to the RCore.
-     * NEVER use this directly! Always use the CORE_LOCK(); macro and access it
-     * like core->...
+     * NEVER use this directly! Always use the CORE_LOCK(); macro (or
+     * CORE_READ_LOCK(); for read-only queries) and access it like core->...
      */
-#if QT_VERSION < QT_VERSION_CHECK(5, 14, 0)
-    QMutex coreMutex;
-#else
-    QRecursiveMutex coreMutex;
-#endif
+    IaitoCoreLock coreLock;
     int coreLockDepth = 0;
+    // serializes io between the holders of the shared lock, see ioReadAt()
+    QMutex ioMutex;
     void *coreBed = nullptr;
 
     AsyncTaskManager *asyncTaskManager;
+    MemoryPageCache *memoryPageCache = nullptr;
+    InstructionIndex *instructionIndex = nullptr;
+    CommentCache *commentCache = nullptr;
+    DensityIndex *densityIndex = nullptr;
+    DecompilerCache *decompilerCache = nullptr;
+    DecompilerPrefetcher *decompilerPrefetcher = nullptr;
+    DisassemblyTokenizer *disassemblyTokenizer = nullptr;
+    DebugSnapshot *debugSnapshot = nullptr;
+    Telescope *telescope = nullptr;
     RVA offsetPriorDebugging = RVA_INVALID;
     QErrorMessage msgBox;
 
@@ -825,6 +928,20 @@ public:
     RCore *operator->() const;
 };
 
+class IAITO_EXPORT RCoreReadLocked
+{
+    IaitoCore *const core;
+
+public:
+    explicit RCoreReadLocked(IaitoCore *core);
+    RCoreReadLocked(const RCoreReadLocked &) = delete;
+    RCoreReadLocked &operator=(const RCoreReadLocked &) = delete;
+    RCoreReadLocked(RCoreReadLocked &&);
+    ~RCoreReadLocked();
+    operator RCore *() const;
+    RCore *operator->() const;
+};
+
 #if R2_VERSION_NUMBER >= 50909
 #define r_flag_get_i r_flag_get_in
 #endif
@@ -0,0 +1,114 @@
+#include "core/IaitoCoreLock.h"
+
+#include <QThread>
+
+#include <cassert>
+
+namespace {
+/**
+ * Per thread bookkeeping, there is only one IaitoCoreLock (owned by
+ * IaitoCore) so it does not need to be keyed by lock.
+ */
+struct ThreadLockState
+{
+    // nesting depth of shared locks owning a reader slot
+    int shared = 0;
+    // nesting depth of shared locks taken while owning the exclusive lock
+    int sharedAsWriter = 0;
+    // shared depth given up while upgrading to the exclusive lock
+    int suspendedShared = 0;
+};
+
+thread_local ThreadLockState threadState;
+} // namespace
+
+void IaitoCoreLock::lockExclusive()
+{
+    QMutexLocker locker(&stateMutex);
+    Qt::HANDLE self = QThread::currentThreadId();
+    if (writer == self) {
+        writerDepth++;
+        return;
+    }
+
+    bool upgrade = threadState.shared > 0;
+    if (upgrade) {
+        // Give up our reader slot, otherwise two upgrading threads would wait
+        // for each other forever.
+        readers--;
+        stateChanged.wakeAll();
+    }
+
+    waitingWriters++;
+    while (writer || readers > 0) {
+        stateChanged.wait(&stateMutex);
+    }
+    waitingWriters--;
+
+    writer = self;
+    writerDepth = 1;
+    if (upgrade) {
+        threadState.suspendedShared = threadState.shared;
+        threadState.shared = 0;
+    }
+}
+
+void IaitoCoreLock::unlockExclusive()
+{
+    QMutexLocker locker(&stateMutex);
+    assert(writer == QThread::currentThreadId() && writerDepth > 0);
+    if (--writerDepth > 0) {
+        return;
+    }
+
+    writer = nullptr;
+    if (threadState.suspendedShared > 0) {
+        threadState.shared = threadState.suspendedShared;
+        threadState.suspendedShared = 0;
+        readers++;
+    }
+    stateChanged.wakeAll();
+}
+
+void IaitoCoreLock::lockShared()
+{
+    QMutexLocker locker(&stateMutex);
+    if (writer == QThread::currentThreadId()) {
+        writerDepth++;
+        threadState.sharedAsWriter++;
+        return;
+    }
+    if (threadState.shared > 0) {
+        threadState.shared++;
+        return;
+    }
+
+    while (writer || waitingWriters > 0) {
+        stateChanged.wait(&stateMutex);
+    }
+    readers++;
+    threadState.shared = 1;
+}
+
+void IaitoCoreLock::unlockShared()
+{
+    if (threadState.sharedAsWriter > 0) {
+        threadState.sharedAsWriter--;
+        unlockExclusive();
+        return;
+    }
+
+    QMutexLocker locker(&stateMutex);
+    assert(threadState.shared > 0 && readers > 0);
+    if (--threadState.shared > 0) {
+        return;
+    }
+    readers--;
+    stateChanged.wakeAll();
+}
+
+bool IaitoCoreLock::isExclusiveOwner()
+{
+    QMutexLocker locker(&stateMutex);
+    return writer == QThread::currentThreadId();
+}
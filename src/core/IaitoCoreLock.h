@@ -0,0 +1,60 @@
+#ifndef IAITOCORELOCK_H
+#define IAITOCORELOCK_H
+
+#include "core/IaitoCommon.h"
+
+#include <QMutex>
+#include <QWaitCondition>
+
+/**
+ * @brief Reader/writer lock guarding the RCore instance.
+ *
+ * Exclusive ownership is required by anything that may modify the core state,
+ * which includes running any r2 command (r_cons output and the seek are
+ * global). Shared ownership is enough for pure queries going through the
+ * native API (function and flag lookups, metadata, io reads), so several
+ * widgets can run those at the same time.
+ *
+ * A command keeps the exclusive lock until it returns, so readers still wait
+ * for a whole aa, aaa or aaaa. AnalTask only lets them in between the
+ * commands of its list, as when the analysis is picked pass by pass.
+ *
+ * Both modes are recursive for the owning thread:
+ *  - a thread owning the exclusive lock may take it again or take a shared
+ *    lock, both are treated as nested exclusive locks.
+ *  - a thread owning a shared lock may take it again.
+ *  - a thread owning a shared lock that asks for the exclusive lock gives up
+ *    its shared ownership while waiting, so the upgrade is not atomic: state
+ *    read before may have changed once the exclusive lock is granted.
+ *
+ * Waiting writers have priority over new readers.
+ */
+class IAITO_EXPORT IaitoCoreLock
+{
+public:
+    IaitoCoreLock() = default;
+
+    void lockExclusive();
+    void unlockExclusive();
+    void lockShared();
+    void unlockShared();
+
+    /**
+     * @return true if the calling thread currently owns the exclusive lock
+     */
+    bool isExclusiveOwner();
+
+private:
+    IaitoCoreLock(const IaitoCoreLock &) = delete;
+    IaitoCoreLock &operator=(const IaitoCoreLock &) = delete;
+
+    QMutex stateMutex;
+    QWaitCondition stateChanged;
+
+    Qt::HANDLE writer = nullptr;
+    int writerDepth = 0;
+    int waitingWriters = 0;
+    int readers = 0;
+};
+
+#endif // IAITOCORELOCK_H
@@ -11,6 +11,7 @@
 #include <QMetaType>
 #include <QString>
 #include <QStringList>
+#include <QVector>
 
 struct FunctionDescription
 {
@@ -211,10 +212,37 @@ struct RAsmPluginDescription
     QString license;
 };
 
+/**
+ * @brief Run of characters of a disassembly line printed in the same color
+ */
+struct DisassemblyToken
+{
+    enum class Type { Text, Mnemonic, Register, Immediate, Address, Comment, Flag };
+
+    // range in DisassemblyText::plain
+    int start;
+    int length;
+    Type type = Type::Text;
+    // Configuration::ColorId of the palette entry the run is colored with, -1
+    // if it has the default color or one that is not in the palette
+    int colorRole = -1;
+    // color printed by r2, used when colorRole is -1, invalid for the default
+    QColor color;
+    // invalid if the run has no background
+    QColor background;
+};
+
+struct DisassemblyText
+{
+    QString plain;
+    // cover plain from start to end
+    QVector<DisassemblyToken> tokens;
+};
+
 struct DisassemblyLine
 {
     RVA offset;
-    QString text;
+    DisassemblyText text;
     RVA arrow;
 };
 
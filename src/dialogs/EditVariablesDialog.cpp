@@ -1,4 +1,5 @@
 #include "EditVariablesDialog.h"
+#include "common/DecompilerCache.h"
 #include "ui_EditVariablesDialog.h"
 
 #include <QComboBox>
@@ -71,6 +72,7 @@ void EditVariablesDialog::applyFields()
     }
 
     // Refresh the views to reflect the changes to vars
+    Core()->getDecompilerCache()->invalidate(Core()->getFunctionStart(functionAddress));
     emit Core() -> refreshCodeViews();
 }
 
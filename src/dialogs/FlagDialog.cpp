@@ -14,7 +14,7 @@ FlagDialog::FlagDialog(RVA offset, QWidget *parent)
     // Setup UI
     ui->setupUi(this);
     setWindowFlags(windowFlags() & (~Qt::WindowContextHelpButtonHint));
-    RFlagItem *flag = r_flag_get_i(Core()->core()->flags, offset);
+    RFlagItem *flag = r_flag_get_i(Core()->coreRead()->flags, offset);
     if (flag) {
         flagName = QString(flag->name);
 #if R2_VERSION_NUMBER >= 50909
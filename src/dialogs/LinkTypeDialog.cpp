@@ -1,4 +1,5 @@
 #include "LinkTypeDialog.h"
+#include "common/DecompilerCache.h"
 #include "ui_LinkTypeDialog.h"
 
 LinkTypeDialog::LinkTypeDialog(QWidget *parent)
@@ -70,7 +71,8 @@ void LinkTypeDialog::done(int r)
             // Seek to the specified address
             Core()->seekAndShow(address);
 
-            // Refresh the views
+            // Refresh the views, the type may show up in any function
+            Core()->getDecompilerCache()->invalidate();
             emit Core() -> refreshCodeViews();
             return;
         }
@@ -1,6 +1,7 @@
 #include "XrefsDialog.h"
 #include "ui_XrefsDialog.h"
 
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "common/TempConfig.h"
 
@@ -236,7 +237,8 @@ void XrefModel::readForOffset(RVA offset, bool to, bool whole_function)
 {
     beginResetModel();
     this->to = to;
-    xrefs = Core()->getXRefs(offset, to, whole_function);
+    xrefs = Core()->getXRefs(offset, to, whole_function, QString(), false);
+    targetNamesResolved.fill(false, xrefs.size());
     endResetModel();
 }
 
@@ -245,9 +247,34 @@ void XrefModel::readForVariable(QString nameOfVariable, bool write, RVA offset)
     beginResetModel();
     this->to = write;
     xrefs = Core()->getXRefsForVariable(nameOfVariable, write, offset);
+    targetNamesResolved.fill(true, xrefs.size());
     endResetModel();
 }
 
+const QString &XrefModel::targetName(int row) const
+{
+    if (!targetNamesResolved.testBit(row)) {
+        // Views ask for neighbouring rows right after, so resolve a whole
+        // page of them with a single core query
+        const int pageSize = 256;
+        const int end = qMin(row + pageSize, xrefs.size());
+        QList<RVA> targets;
+        for (int i = row; i < end; i++) {
+            if (!targetNamesResolved.testBit(i)) {
+                targets << xrefs.at(i).to;
+            }
+        }
+        const QHash<RVA, QString> names = Core()->getNearestFlagNames(targets);
+        for (int i = row; i < end; i++) {
+            if (!targetNamesResolved.testBit(i)) {
+                xrefs[i].to_str = names.value(xrefs.at(i).to);
+                targetNamesResolved.setBit(i);
+            }
+        }
+    }
+    return xrefs.at(row).to_str;
+}
+
 int XrefModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent)
@@ -272,7 +299,7 @@ QVariant XrefModel::data(const QModelIndex &index, int role) const
     case Qt::DisplayRole:
         switch (index.column()) {
         case OFFSET:
-            return to ? xref.from_str : xref.to_str;
+            return to ? xref.from_str : targetName(index.row());
         case TYPE:
             return xrefTypeString(xref.type);
         case CODE:
@@ -282,11 +309,15 @@ QVariant XrefModel::data(const QModelIndex &index, int role) const
                 return QString();
             }
         case COMMENT:
-            return to ? Core()->getCommentAt(xref.from) : Core()->getCommentAt(xref.to);
+            return to ? Core()->getCommentCache()->at(xref.from)
+                      : Core()->getCommentCache()->at(xref.to);
         }
         return QVariant();
     case FlagDescriptionRole:
-        return QVariant::fromValue(xref);
+        if (!to) {
+            targetName(index.row());
+        }
+        return QVariant::fromValue(xrefs.at(index.row()));
     default:
         break;
     }
@@ -5,15 +5,20 @@
 #include "common/Highlighter.h"
 #include "core/Iaito.h"
 #include <memory>
+#include <QBitArray>
 #include <QDialog>
 #include <QTreeWidgetItem>
 
 class XrefModel : public AddressableItemModel<QAbstractListModel>
 {
 private:
-    QList<XrefDescription> xrefs;
+    // to_str is resolved lazily for the rows being displayed
+    mutable QList<XrefDescription> xrefs;
+    mutable QBitArray targetNamesResolved;
     bool to;
 
+    const QString &targetName(int row) const;
+
 public:
     enum Columns { OFFSET = 0, TYPE, CODE, COMMENT, COUNT };
     static const int FlagDescriptionRole = Qt::UserRole;
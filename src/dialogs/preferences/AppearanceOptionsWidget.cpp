@@ -81,6 +81,11 @@ AppearanceOptionsWidget::AppearanceOptionsWidget(PreferencesDialog *dialog)
     connect(ui->useDecompilerHighlighter, &QCheckBox::toggled, this, [](bool checked) {
         Config()->enableDecompilerAnnotationHighlighter(checked);
     });
+
+    ui->decompilerPrefetch->setChecked(Config()->getDecompilerPrefetchEnabled());
+    connect(ui->decompilerPrefetch, &QCheckBox::toggled, this, [](bool checked) {
+        Config()->setDecompilerPrefetchEnabled(checked);
+    });
 }
 
 AppearanceOptionsWidget::~AppearanceOptionsWidget() {}
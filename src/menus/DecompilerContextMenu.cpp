@@ -215,7 +215,7 @@ void DecompilerContextMenu::aboutToShowSlot()
                 tr("Rename function %1").arg(QString(annotationHere->reference.name)));
         } else if (annotationHere->type == R_CODEMETA_TYPE_GLOBAL_VARIABLE) {
             RFlagItem *flagDetails
-                = r_flag_get_i(Core()->core()->flags, annotationHere->reference.offset);
+                = r_flag_get_i(Core()->coreRead()->flags, annotationHere->reference.offset);
             if (flagDetails) {
                 actionRenameThingHere.setText(tr("Rename %1").arg(QString(flagDetails->name)));
                 actionDeleteName.setText(tr("Remove %1").arg(QString(flagDetails->name)));
@@ -229,7 +229,7 @@ void DecompilerContextMenu::aboutToShowSlot()
     if (isReference()) {
         actionCopyReferenceAddress.setVisible(true);
         RVA referenceAddr = annotationHere->reference.offset;
-        RFlagItem *flagDetails = r_flag_get_i(Core()->core()->flags, referenceAddr);
+        RFlagItem *flagDetails = r_flag_get_i(Core()->coreRead()->flags, referenceAddr);
         if (annotationHere->type == R_CODEMETA_TYPE_FUNCTION_NAME) {
             actionCopyReferenceAddress.setText(
                 tr("Copy address of %1 (%2)")
@@ -476,7 +476,7 @@ DisassemblyContextMenu::ThingUsedHere DisassemblyContextMenu::getThingAt(ut64 ad
 {
     ThingUsedHere tuh;
     RAnalFunction *fcn = Core()->functionAt(address);
-    RFlagItem *flag = r_flag_get_i(Core()->core()->flags, address);
+    RFlagItem *flag = r_flag_get_i(Core()->coreRead()->flags, address);
 
     // We will lookup through existing r2 types to find something relevant
 
@@ -1199,6 +1199,8 @@ void DisassemblyContextMenu::setColor(const char *color)
     } else {
         Core()->cmd("abc-");
     }
+    // block colors are cached by the graph until the instructions change
+    emit Core()->instructionChanged(offset);
 }
 
 void DisassemblyContextMenu::setToData(int size, int repeat)
@@ -1,5 +1,6 @@
 #include "BacktraceWidget.h"
 #include "QHeaderView"
+#include "common/DebugSnapshot.h"
 #include "common/JsonModel.h"
 #include "ui_BacktraceWidget.h"
 
@@ -39,13 +40,19 @@ void BacktraceWidget::updateContents()
     if (!refreshDeferrer->attemptRefresh(nullptr) || Core()->isDebugTaskInProgress()) {
         return;
     }
+    quint64 changed;
+    Core()->getDebugSnapshot()->getBacktrace(&changed);
+    if (changed == shownBacktrace) {
+        return;
+    }
+    shownBacktrace = changed;
 
     setBacktraceGrid();
 }
 
 void BacktraceWidget::setBacktraceGrid()
 {
-    QJsonArray backtraceValues = Core()->getBacktrace().array();
+    QJsonArray backtraceValues = Core()->getDebugSnapshot()->getBacktrace();
     int i = 0;
     for (const QJsonValueRef value : backtraceValues) {
         QJsonObject backtraceItem = value.toObject();
@@ -32,4 +32,6 @@ private:
     QStandardItemModel *modelBacktrace = new QStandardItemModel(1, 5, this);
     QTableView *viewBacktrace = new QTableView(this);
     RefreshDeferrer *refreshDeferrer;
+    // DebugSnapshot generation of the backtrace shown
+    quint64 shownBacktrace = 0;
 };
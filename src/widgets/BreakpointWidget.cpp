@@ -1,4 +1,5 @@
 #include "BreakpointWidget.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "dialogs/BreakpointsDialog.h"
@@ -70,7 +71,7 @@ QVariant BreakpointModel::data(const QModelIndex &index, int role) const
         case EnabledColumn:
             return breakpoint.enabled;
         case CommentColumn:
-            return Core()->getCommentAt(breakpoint.addr);
+            return Core()->getCommentCache()->at(breakpoint.addr);
         default:
             return QVariant();
         }
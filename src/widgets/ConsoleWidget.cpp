@@ -1,18 +1,29 @@
 #include "ConsoleWidget.h"
 #include "WidgetShortcuts.h"
+#include "common/CommentCache.h"
+#include "common/ConsoleOutputReader.h"
+#include "common/DebugSnapshot.h"
+#include "common/DecompilerCache.h"
+#include "common/DensityIndex.h"
+#include "common/DisassemblyTokenizer.h"
 #include "common/Helpers.h"
+#include "common/InstructionIndex.h"
+#include "common/MemoryPageCache.h"
 #include "common/SvgIconEngine.h"
 #include "core/Iaito.h"
 #include "ui_ConsoleWidget.h"
+#include <climits>
 #include <iostream>
 #include <QAction>
 #include <QCompleter>
 #include <QDir>
+#include <QInputDialog>
 #include <QMenu>
 #include <QScrollBar>
 #include <QSettings>
 #include <QShortcut>
 #include <QStringListModel>
+#include <QTextCursor>
 #include <QTimer>
 #include <QUuid>
 
@@ -37,6 +48,14 @@
 static const int invalidHistoryPos = -1;
 
 static const char *consoleWrapSettingsKey = "console.wrap";
+static const char *consoleScrollbackSettingsKey = "console.scrollback";
+
+// Blocks kept in the output, 0 keeps everything, a limit is opt-in from the
+// context menu
+static const int defaultScrollback = 0;
+// Redirected output is flushed at most once per frame
+static const int outputFlushInterval = 16;
+static const int maxLinesPerFlush = 1000;
 
 ConsoleWidget::ConsoleWidget(MainWindow *main)
     : IaitoDockWidget(main)
@@ -87,6 +106,30 @@ ConsoleWidget::ConsoleWidget(MainWindow *main)
     connect(actionWrapLines, &QAction::triggered, this, [this](bool checked) { setWrap(checked); });
     actions.append(actionWrapLines);
 
+    QAction *actionScrollback = new QAction(tr("Scrollback Lines..."), ui->outputTextEdit);
+    connect(actionScrollback, &QAction::triggered, this, [this]() {
+        bool ok;
+        int lines = QInputDialog::getInt(
+            this,
+            tr("Scrollback Lines"),
+            tr("Lines kept in the console (0 for unlimited):"),
+            ui->outputTextEdit->maximumBlockCount(),
+            0,
+            INT_MAX,
+            1000,
+            &ok);
+        if (ok) {
+            QSettings().setValue(consoleScrollbackSettingsKey, lines);
+            setScrollback(lines);
+        }
+    });
+    actions.append(actionScrollback);
+    setScrollback(QSettings().value(consoleScrollbackSettingsKey, defaultScrollback).toInt());
+
+    outputFlushTimer.setSingleShot(true);
+    outputFlushTimer.setInterval(outputFlushInterval);
+    connect(&outputFlushTimer, &QTimer::timeout, this, &ConsoleWidget::processQueuedOutput);
+
     // Completion
     completionActive = false;
     completer = new QCompleter(&completionModel, this);
@@ -157,6 +200,9 @@ ConsoleWidget::ConsoleWidget(MainWindow *main)
 
 ConsoleWidget::~ConsoleWidget()
 {
+    outputThread.quit();
+    outputThread.wait();
+    delete outputReader;
 #ifndef Q_OS_WIN
     ::close(stdinFile);
     remove(stdinFifoPath.toStdString().c_str());
@@ -244,6 +290,7 @@ void ConsoleWidget::executeCommand(const QString &command)
     } else {
         result = Core()->cmdHtml(command.toStdString().c_str());
     }
+    invalidateCaches();
     if (oldOffset != Core()->getOffset()) {
         Core()->updateSeek();
     }
@@ -268,6 +315,7 @@ void ConsoleWidget::executeCommand(const QString &command)
             ui->r2InputLineEdit->setEnabled(true);
             ui->r2InputLineEdit->setFocus();
 
+            invalidateCaches();
             if (oldOffset != Core()->getOffset()) {
                 Core()->updateSeek();
             }
@@ -277,6 +325,19 @@ void ConsoleWidget::executeCommand(const QString &command)
 #endif
 }
 
+void ConsoleWidget::invalidateCaches()
+{
+    // any command may have written to io or changed the analysis behind the
+    // caches
+    Core()->getMemoryPageCache()->invalidate();
+    Core()->getInstructionIndex()->invalidate();
+    Core()->getCommentCache()->invalidate();
+    Core()->getDensityIndex()->invalidate();
+    Core()->getDecompilerCache()->invalidate();
+    Core()->getDisassemblyTokenizer()->invalidate();
+    Core()->getDebugSnapshot()->invalidate();
+}
+
 void ConsoleWidget::sendToStdin(const QString &input)
 {
 #if R2__UNIX__
@@ -316,6 +377,11 @@ void ConsoleWidget::setWrap(bool wrap)
     ui->outputTextEdit->setLineWrapMode(wrap ? QPlainTextEdit::WidgetWidth : QPlainTextEdit::NoWrap);
 }
 
+void ConsoleWidget::setScrollback(int lines)
+{
+    ui->outputTextEdit->setMaximumBlockCount(lines);
+}
+
 void ConsoleWidget::on_r2InputLineEdit_returnPressed()
 {
     QString input = ui->r2InputLineEdit->text();
@@ -452,21 +518,44 @@ void ConsoleWidget::invalidateHistoryPosition()
     lastHistoryPosition = invalidHistoryPos;
 }
 
-void ConsoleWidget::processQueuedOutput()
+void ConsoleWidget::scheduleQueuedOutput()
 {
-    // Partial lines are ignored since carriage return is currently unsupported
-    while (pipeSocket->canReadLine()) {
-        QString output = QString(pipeSocket->readLine());
+    if (!outputFlushTimer.isActive()) {
+        outputFlushTimer.start();
+    }
+}
 
-        if (origStderr) {
-            fprintf(origStderr, "%s", output.toStdString().c_str());
+void ConsoleWidget::processQueuedOutput()
+{
+    int dropped;
+    const QStringList lines = outputReader->takeLines(maxLinesPerFlush, &dropped);
+
+    // All lines go in as one edit so the layout and the scrollbar are only
+    // updated once per flush
+    QTextDocument *document = ui->outputTextEdit->document();
+    QTextCursor cursor(document);
+    cursor.movePosition(QTextCursor::End);
+    cursor.beginEditBlock();
+    auto appendLine = [&](const QString &html) {
+        if (!document->isEmpty()) {
+            cursor.insertBlock(QTextBlockFormat(), QTextCharFormat());
         }
+        cursor.setCharFormat(QTextCharFormat());
+        cursor.insertHtml(html);
+    };
+    if (dropped) {
+        appendLine(QStringLiteral("<font color=\"gray\">%1</font>")
+                       .arg(tr("[%n line(s) of output dropped]", "", dropped)));
+    }
+    for (const QString &line : lines) {
+        appendLine(line);
+    }
+    cursor.endEditBlock();
+    scrollOutputToEnd();
 
-        // Get the last segment that wasn't overwritten by carriage return
-        output = output.trimmed();
-        output = output.remove(0, output.lastIndexOf('\r')).trimmed();
-        ui->outputTextEdit->appendHtml(IaitoCore::ansiEscapeToHtml(output));
-        scrollOutputToEnd();
+    // The rest is taken on the next frame so input and painting get a turn
+    if (outputReader->pendingCount() > 0) {
+        outputFlushTimer.start();
     }
 }
 
@@ -492,11 +581,12 @@ void ConsoleWidget::redirectOutput()
         return;
     }
 
-    pipeSocket = new QLocalSocket(this);
-
     origStdin = fdopen(dup(fileno(stderr)), "r");
     origStderr = fdopen(dup(fileno(stderr)), "a");
     origStdout = fdopen(dup(fileno(stdout)), "a");
+
+    outputReader = new ConsoleOutputReader(origStderr);
+    QLocalSocket *pipeSocket = outputReader->getSocket();
 #ifdef Q_OS_WIN
     QString pipeName = QString::fromLatin1(PIPE_NAME).arg(QUuid::createUuid().toString());
 
@@ -541,5 +631,13 @@ void ConsoleWidget::redirectOutput()
     pipeSocket->connectToServer(QIODevice::ReadOnly);
 #endif
 
-    connect(pipeSocket, &QIODevice::readyRead, this, &ConsoleWidget::processQueuedOutput);
+    connect(
+        outputReader,
+        &ConsoleOutputReader::linesAvailable,
+        this,
+        &ConsoleWidget::scheduleQueuedOutput);
+    // The socket moves along as a child of the reader
+    outputReader->moveToThread(&outputThread);
+    outputThread.setObjectName("ConsoleOutput");
+    outputThread.start();
 }
@@ -9,11 +9,14 @@
 #include <QLocalSocket>
 #include <QSocketNotifier>
 #include <QStringListModel>
+#include <QThread>
+#include <QTimer>
 
 #include <memory>
 
 class QCompleter;
 class QShortcut;
+class ConsoleOutputReader;
 
 namespace Ui {
 class ConsoleWidget;
@@ -63,9 +66,10 @@ private slots:
     void clear();
 
     /**
-     * @brief Passes redirected output from the pipe to the terminal and console
+     * @brief Flushes the next batch of redirected output into the console
      */
     void processQueuedOutput();
+    void scheduleQueuedOutput();
 
 public:
     void unredirectOutput();
@@ -76,12 +80,17 @@ private:
     void invalidateHistoryPosition();
     void removeLastLine();
     void executeCommand(const QString &command);
+    /**
+     * @brief Drop what the core caches after a command the console ran
+     */
+    void invalidateCaches();
     void sendToStdin(const QString &input);
     void setWrap(bool wrap);
+    void setScrollback(int lines);
 
     /**
-     * @brief Redirects stderr and stdout to the output pipe which is handled by
-     *        processQueuedOutput
+     * @brief Redirects stderr and stdout to the output pipe which is read by
+     *        outputReader on outputThread and flushed by processQueuedOutput
      */
     void redirectOutput();
 
@@ -102,7 +111,9 @@ private:
     FILE *origStderr = nullptr;
     FILE *origStdout = nullptr;
     FILE *origStdin = nullptr;
-    QLocalSocket *pipeSocket = nullptr;
+    ConsoleOutputReader *outputReader = nullptr;
+    QThread outputThread;
+    QTimer outputFlushTimer;
 #ifdef Q_OS_WIN
     HANDLE hRead;
     HANDLE hWrite;
@@ -4,6 +4,8 @@
 
 #include "common/Configuration.h"
 #include "common/Decompiler.h"
+#include "common/DecompilerCache.h"
+#include "common/DecompilerPrefetcher.h"
 #include "common/DecompilerHighlighter.h"
 #include "common/Helpers.h"
 #include "common/IaitoSeekable.h"
@@ -270,6 +272,15 @@ void DecompilerWidget::doRefresh()
         return;
     }
     mCtxMenu->setDecompiledFunctionAddress(decompiledFunctionAddr);
+    DecompilerCache *cache = Core()->getDecompilerCache();
+    if (DecompilerCache::Code cached = cache->find(dec->getId(), decompiledFunctionAddr)) {
+        ui->progressLabel->setVisible(false);
+        ui->decompilerComboBox->setEnabled(decompilerSelectionEnabled);
+        showCode(cached);
+        return;
+    }
+    decompilingId = dec->getId();
+    decompilingGeneration = cache->generation(decompiledFunctionAddr);
     connect(dec, &Decompiler::finished, this, &DecompilerWidget::decompilationFinished);
     decompilerBusy = true;
 #if MONOTHREAD
@@ -285,6 +296,8 @@ void DecompilerWidget::doRefresh()
 
 void DecompilerWidget::refreshDecompiler()
 {
+    // Asked for explicitly, so decompile again
+    Core()->getDecompilerCache()->invalidate(decompiledFunctionAddr);
     doRefresh();
     setInfoForBreakpoints();
 }
@@ -301,6 +314,24 @@ QTextCursor DecompilerWidget::getCursorForAddress(RVA addr)
 }
 
 void DecompilerWidget::decompilationFinished(RCodeMeta *codeDecompiled)
+{
+    ui->progressLabel->setVisible(false);
+    ui->decompilerComboBox->setEnabled(decompilerSelectionEnabled);
+
+    Decompiler *dec = getCurrentDecompiler();
+    QObject::disconnect(dec, &Decompiler::finished, this, &DecompilerWidget::decompilationFinished);
+    decompilerBusy = false;
+
+    std::shared_ptr<RCodeMeta> decompiled(codeDecompiled, &r_codemeta_free);
+    // Warnings have no annotations, only keep actual code around
+    if (r_vector_len(&codeDecompiled->annotations)) {
+        Core()->getDecompilerCache()->insert(
+            decompilingId, decompiledFunctionAddr, decompilingGeneration, decompiled);
+    }
+    showCode(decompiled);
+}
+
+void DecompilerWidget::showCode(std::shared_ptr<RCodeMeta> code)
 {
     bool isDisplayReset = false;
     if (previousFunctionAddr == decompiledFunctionAddr) {
@@ -309,15 +340,8 @@ void DecompilerWidget::decompilationFinished(RCodeMeta *codeDecompiled)
         isDisplayReset = true;
     }
 
-    ui->progressLabel->setVisible(false);
-    ui->decompilerComboBox->setEnabled(decompilerSelectionEnabled);
-
     mCtxMenu->setAnnotationHere(nullptr);
-    setCode(codeDecompiled);
-
-    Decompiler *dec = getCurrentDecompiler();
-    QObject::disconnect(dec, &Decompiler::finished, this, &DecompilerWidget::decompilationFinished);
-    decompilerBusy = false;
+    setCode(std::move(code));
 
     if (ui->textEdit->toPlainText().isEmpty()) {
         setCode(Decompiler::makeWarning(tr("Cannot decompile at this address (Not a function?)")));
@@ -325,13 +349,15 @@ void DecompilerWidget::decompilationFinished(RCodeMeta *codeDecompiled)
         highestOffsetInCode = 0;
         return;
     }
+    Core()->getDecompilerPrefetcher()->functionShown(
+        getCurrentDecompiler(), decompiledFunctionAddr);
     updateCursorPosition();
     highlightPC();
     highlightBreakpoints();
     lowestOffsetInCode = RVA_MAX;
     highestOffsetInCode = 0;
     void *iter;
-    r_vector_foreach(&code->annotations, iter)
+    r_vector_foreach(&this->code->annotations, iter)
     {
         RCodeMetaItem *annotation = (RCodeMetaItem *) iter;
         if (annotation->type == R_CODEMETA_TYPE_OFFSET) {
@@ -637,12 +663,17 @@ static QString remapAnnotationOffsetsToQString(RCodeMeta &code)
 }
 
 void DecompilerWidget::setCode(RCodeMeta *code)
+{
+    setCode(std::shared_ptr<RCodeMeta>(code, &r_codemeta_free));
+}
+
+void DecompilerWidget::setCode(std::shared_ptr<RCodeMeta> code)
 {
     connectCursorPositionChanged(false);
     if (auto highlighter = qobject_cast<DecompilerHighlighter *>(syntaxHighlighter.get())) {
-        highlighter->setAnnotations(code);
+        highlighter->setAnnotations(code.get());
     }
-    this->code.reset(code);
+    this->code = std::move(code);
     QString text = remapAnnotationOffsetsToQString(*this->code);
     this->ui->textEdit->setPlainText(text);
     connectCursorPositionChanged(true);
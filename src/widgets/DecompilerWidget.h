@@ -78,7 +78,11 @@ private:
     int scrollerVertical;
     RVA previousFunctionAddr;
     RVA decompiledFunctionAddr;
-    std::unique_ptr<RCodeMeta, void (*)(RCodeMeta *)> code;
+    // decompiler and cache generation of the running decompilation
+    QString decompilingId;
+    quint64 decompilingGeneration = 0;
+    // shared with the decompiler cache
+    std::shared_ptr<RCodeMeta> code;
 
     /**
      * Specifies the lowest offset of instructions among all the instructions in
@@ -253,6 +257,12 @@ private:
     bool addressInRange(RVA addr);
 
     void setCode(RCodeMeta *code);
+    void setCode(std::shared_ptr<RCodeMeta> code);
+    /**
+     * @brief Show the code of decompiledFunctionAddr, fresh from the decompiler
+     * or from the cache
+     */
+    void showCode(std::shared_ptr<RCodeMeta> code);
 
     void setHighlighter(bool annotationBasedHighlighter);
 };
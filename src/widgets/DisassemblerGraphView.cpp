@@ -4,6 +4,7 @@
 #include "common/BasicInstructionHighlighter.h"
 #include "common/Colors.h"
 #include "common/Configuration.h"
+#include "common/DisassemblyTokenizer.h"
 #include "common/Helpers.h"
 #include "common/IaitoSeekable.h"
 #include "common/SyntaxHighlighter.h"
@@ -22,7 +23,6 @@
 #include <QPropertyAnimation>
 #include <QRegularExpression>
 #include <QShortcut>
-#include <QTextDocument>
 #include <QTextEdit>
 #include <QToolTip>
 #include <QVBoxLayout>
@@ -254,6 +254,7 @@ void DisassemblerGraphView::loadCurrentGraph()
             db.header_text = Text(
                 "[" + RAddressString(db.entry) + "]", ConfigColor("offset"), QColor(0, 0, 0, 0));
         }
+        db.color = blockColor(block_entry);
         db.true_path = RVA_INVALID;
         db.false_path = RVA_INVALID;
         if (block_fail) {
@@ -282,6 +283,7 @@ void DisassemblerGraphView::loadCurrentGraph()
         }
 
         QJsonArray opArray = block["ops"].toArray();
+        DisassemblyTokenizer *tokenizer = Core()->getDisassemblyTokenizer();
         for (int opIndex = 0; opIndex < opArray.size(); opIndex++) {
             QJsonObject op = opArray[opIndex].toObject();
             Instr i;
@@ -296,13 +298,10 @@ void DisassemblerGraphView::loadCurrentGraph()
                 i.size = (block_entry + block_size) - i.addr;
             }
 
-            QTextDocument textDoc;
-            textDoc.setHtml(IaitoCore::ansiEscapeToHtml(op["text"].toString()));
+            const DisassemblyText text = tokenizer->tokenize(op["text"].toString());
+            i.plainText = text.plain;
 
-            i.plainText = textDoc.toPlainText();
-
-            RichTextPainter::List richText = RichTextPainter::fromTextDocument(textDoc);
-            // Colors::colorizeAssembly(richText, textDoc.toPlainText(), 0);
+            RichTextPainter::List richText = DisassemblyTokenizer::richText(text);
 
             bool cropped;
             int blockLength = Config()->getGraphBlockMaxChars()
@@ -327,6 +326,16 @@ void DisassemblerGraphView::loadCurrentGraph()
     }
 }
 
+QColor DisassemblerGraphView::blockColor(RVA entry)
+{
+    auto core = Core()->coreRead();
+    RAnalBlock *bb = r_anal_get_block_at(core->anal, entry);
+    if (!bb || !bb->colorize) {
+        return QColor();
+    }
+    return QColor(QRgb(0xff000000 | bb->colorize));
+}
+
 DisassemblerGraphView::EdgeConfigurationMapping DisassemblerGraphView::getEdgeConfigurations()
 {
     EdgeConfigurationMapping result;
@@ -388,15 +397,11 @@ void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block,
     // Figure out if the current block is selected
     RVA addr = seekable->getOffset();
     RVA PCAddr = Core()->getProgramCounterValue();
-    RVA bbAddr = UT64_MAX;
     for (const Instr &instr : db.instrs) {
         if (instr.contains(addr) && interactive) {
             block_selected = true;
             selected_instruction = instr.addr;
         }
-        if (bbAddr == UT64_MAX) {
-            bbAddr = instr.addr;
-        }
 
         // TODO: L219
     }
@@ -417,11 +422,8 @@ void DisassemblerGraphView::drawBlock(QPainter &p, GraphView::GraphBlock &block,
     } else {
         p.setBrush(disassemblyBackgroundColor);
     }
-    auto bbColor = Core()->cmd("abc @ " + QString::number(bbAddr));
-    if (bbColor != nullptr && bbColor.length() > 1) {
-        char *s = r_str_newf("#ff%s", bbColor.mid(1, 6).toStdString().c_str());
-        p.setBrush(QColor(QString(s)));
-        free(s);
+    if (db.color.isValid()) {
+        p.setBrush(db.color);
     }
 
     // Draw basic block background
@@ -977,13 +979,71 @@ void DisassemblerGraphView::restoreCurrentBlock()
     onSeekChanged(this->seekable->getOffset()); // try to keep the view on current block
 }
 
+void DisassemblerGraphView::layoutApplied()
+{
+    // Unlike restoreCurrentBlock() don't reload the graph if the seek isn't in
+    // any block, that would start another layout
+    RVA addr = seekable->getOffset();
+    DisassemblyBlock *db = blockForAddress(addr);
+    if (db) {
+        transition_dont_seek = true;
+        showBlock(blocks[db->entry]);
+        showInstruction(blocks[db->entry], addr);
+    } else {
+        center();
+    }
+    emit viewRefreshed();
+}
+
 void DisassemblerGraphView::paintEvent(QPaintEvent *event)
 {
-    // DisassemblerGraphView is always dirty
-    setCacheDirty();
+    updateDirtyBlocks();
     GraphView::paintEvent(event);
 }
 
+void DisassemblerGraphView::updateDirtyBlocks()
+{
+    PaintedState state;
+    RVA addr = seekable->getOffset();
+    if (DisassemblyBlock *db = blockForAddress(addr)) {
+        state.selectedBlock = db->entry;
+        for (const Instr &instr : db->instrs) {
+            if (instr.contains(addr)) {
+                state.selectedInstruction = instr.addr;
+                break;
+            }
+        }
+    }
+    state.pc = Core()->getProgramCounterValue();
+    if (DisassemblyBlock *db = blockForAddress(state.pc)) {
+        state.pcBlock = db->entry;
+    }
+    state.currentBlock = currentBlockAddress;
+    if (highlight_token) {
+        state.highlightedToken = highlight_token->content;
+    }
+
+    // A highlighted token can show up in any block, the rest only changes the
+    // look of the blocks involved and of their edges
+    if (state.highlightedToken != paintedState.highlightedToken) {
+        setCacheDirty();
+    } else {
+        if (state.selectedInstruction != paintedState.selectedInstruction) {
+            setBlockDirty(paintedState.selectedBlock);
+            setBlockDirty(state.selectedBlock);
+        }
+        if (state.pc != paintedState.pc) {
+            setBlockDirty(paintedState.pcBlock);
+            setBlockDirty(state.pcBlock);
+        }
+        if (state.currentBlock != paintedState.currentBlock) {
+            setBlockDirty(paintedState.currentBlock);
+            setBlockDirty(state.currentBlock);
+        }
+    }
+    paintedState = state;
+}
+
 bool DisassemblerGraphView::Instr::contains(ut64 addr) const
 {
     return this->addr <= addr && (addr - this->addr) < size;
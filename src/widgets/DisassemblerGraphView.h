@@ -86,6 +86,8 @@ class DisassemblerGraphView : public IaitoGraphView
         ut64 false_path = 0;
         bool terminal = false;
         bool indirectcall = false;
+        // user color of the basic block (abc), invalid if not set
+        QColor color;
     };
 
 public:
@@ -140,6 +142,7 @@ protected:
         GraphView::GraphBlock &block, QContextMenuEvent *event, QPoint pos) override;
     void contextMenuEvent(QContextMenuEvent *event) override;
     void restoreCurrentBlock() override;
+    void layoutApplied() override;
 private slots:
     void showExportDialog() override;
     void onActionHighlightBITriggered();
@@ -152,12 +155,34 @@ private:
     bool emptyGraph;
     ut64 currentBlockAddress = RVA_INVALID;
 
+    /**
+     * @brief State drawBlock() depends on as of the last paint, compared on
+     * each paint to repaint only the blocks whose look changed.
+     */
+    struct PaintedState
+    {
+        RVA selectedInstruction = RVA_INVALID;
+        RVA selectedBlock = RVA_INVALID;
+        RVA pc = RVA_INVALID;
+        RVA pcBlock = RVA_INVALID;
+        RVA currentBlock = RVA_INVALID;
+        QString highlightedToken;
+    };
+    PaintedState paintedState;
+    void updateDirtyBlocks();
+
     DisassemblyContextMenu *blockMenu;
     QMenu *contextMenu;
 
     void connectSeekChanged(bool disconnect);
 
     void prepareGraphNode(GraphBlock &block);
+    /**
+     * @brief Read the color set on the basic block starting at entry.
+     * Colors are cached in DisassemblyBlock by loadCurrentGraph() which runs
+     * again on instructionChanged and graphOptionsChanged.
+     */
+    QColor blockColor(RVA entry);
     Token *getToken(Instr *instr, int x);
 
     QPoint getInstructionOffset(const DisassemblyBlock &block, int line) const;
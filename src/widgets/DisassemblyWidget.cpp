@@ -1,46 +1,31 @@
 #include "DisassemblyWidget.h"
+#include "common/CachedFontMetrics.h"
 #include "common/Configuration.h"
+#include "common/DisassemblyTokenizer.h"
 #include "common/Helpers.h"
-#include "common/SelectionHighlight.h"
 #include "common/TempConfig.h"
 #include "core/MainWindow.h"
 #include "menus/DisassemblyContextMenu.h"
 
 #include <QApplication>
+#include <QClipboard>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QMouseEvent>
 #include <QPainter>
 #include <QPainterPath>
-#include <QRegularExpression>
 #include <QScrollBar>
 #include <QSplitter>
-#include <QTextBlockUserData>
 #include <QToolTip>
 #include <QVBoxLayout>
 
-class DisassemblyTextBlockUserData : public QTextBlockUserData
-{
-public:
-    DisassemblyLine line;
-
-    explicit DisassemblyTextBlockUserData(const DisassemblyLine &line) { this->line = line; }
-};
-
-static DisassemblyTextBlockUserData *getUserData(const QTextBlock &block)
-{
-    QTextBlockUserData *userData = block.userData();
-    if (!userData) {
-        return nullptr;
-    }
-
-    return static_cast<DisassemblyTextBlockUserData *>(userData);
-}
+#include <cmath>
 
 DisassemblyWidget::DisassemblyWidget(MainWindow *main)
     : MemoryDockWidget(MemoryWidgetType::Disassembly, main)
     , mCtxMenu(new DisassemblyContextMenu(this, main))
     , mDisasScrollArea(new DisassemblyScrollArea(this))
-    , mDisasTextEdit(new DisassemblyTextEdit(this))
+    , mDisasTextView(new DisassemblyTextView(this))
 {
     setObjectName(main ? main->getUniqueObjectName(getWidgetType()) : getWidgetType());
     updateWindowTitle();
@@ -59,7 +44,7 @@ DisassemblyWidget::DisassemblyWidget(MainWindow *main)
 
     // Setup the disassembly content
     auto *layout = new QHBoxLayout;
-    layout->addWidget(mDisasTextEdit);
+    layout->addWidget(mDisasTextView);
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     layout->setMargin(0);
 #endif
@@ -69,9 +54,8 @@ DisassemblyWidget::DisassemblyWidget(MainWindow *main)
     // Use stylesheet instead of QWidget::setFrameShape(QFrame::NoShape) to
     // avoid issues with dark and light interface themes
     mDisasScrollArea->setStyleSheet("QAbstractScrollArea { border: 0px transparent black; }");
-    mDisasTextEdit->setStyleSheet("QPlainTextEdit { border: 0px transparent black; }");
-    mDisasTextEdit->setFocusProxy(this);
-    mDisasTextEdit->setFocusPolicy(Qt::ClickFocus);
+    mDisasTextView->setFocusProxy(this);
+    mDisasTextView->setFocusPolicy(Qt::ClickFocus);
     mDisasScrollArea->setFocusProxy(this);
     mDisasScrollArea->setFocusPolicy(Qt::ClickFocus);
 
@@ -110,25 +94,14 @@ DisassemblyWidget::DisassemblyWidget(MainWindow *main)
     maxLines = 0;
     updateMaxLines();
 
-    mDisasTextEdit->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    mDisasTextEdit->setFont(Config()->getFont());
-    mDisasTextEdit->setReadOnly(true);
-    mDisasTextEdit->setLineWrapMode(QPlainTextEdit::WidgetWidth);
-    // wrapping breaks readCurrentDisassemblyOffset() at the moment :-(
-    mDisasTextEdit->setWordWrapMode(QTextOption::NoWrap);
-
-    // Increase asm text edit margin
-    QTextDocument *asm_docu = mDisasTextEdit->document();
-    asm_docu->setDocumentMargin(10);
-
     // Event filter to intercept double clicks in the textbox
     // and showing tooltips when hovering above those offsets
-    mDisasTextEdit->viewport()->installEventFilter(this);
+    mDisasTextView->installEventFilter(this);
 
     // Set Disas context menu
-    mDisasTextEdit->setContextMenuPolicy(Qt::CustomContextMenu);
+    mDisasTextView->setContextMenuPolicy(Qt::CustomContextMenu);
     connect(
-        mDisasTextEdit,
+        mDisasTextView,
         &QWidget::customContextMenuRequested,
         this,
         &DisassemblyWidget::showDisasContextMenu);
@@ -143,13 +116,13 @@ DisassemblyWidget::DisassemblyWidget(MainWindow *main)
         &DisassemblyScrollArea::disassemblyResized,
         this,
         &DisassemblyWidget::updateMaxLines);
+    connect(
+        mDisasScrollArea->horizontalScrollBar(),
+        &QScrollBar::valueChanged,
+        mDisasTextView,
+        &DisassemblyTextView::setHorizontalOffset);
 
     connectCursorPositionChanged(false);
-    connect(mDisasTextEdit->verticalScrollBar(), &QScrollBar::valueChanged, this, [=](int value) {
-        if (value != 0) {
-            mDisasTextEdit->verticalScrollBar()->setValue(0);
-        }
-    });
 
     connect(Core(), &IaitoCore::commentsChanged, this, [this]() { refreshDisasm(); });
     connect(Core(), SIGNAL(flagsChanged()), this, SLOT(refreshDisasm()));
@@ -169,14 +142,14 @@ DisassemblyWidget::DisassemblyWidget(MainWindow *main)
     });
     refreshDisasm(seekable->getOffset());
 
-    connect(mCtxMenu, &DisassemblyContextMenu::copy, mDisasTextEdit, &QPlainTextEdit::copy);
+    connect(mCtxMenu, &DisassemblyContextMenu::copy, mDisasTextView, &DisassemblyTextView::copy);
 
     mCtxMenu->addSeparator();
     mCtxMenu->addAction(&syncAction);
     connect(seekable, &IaitoSeekable::seekableSeekChanged, this, &DisassemblyWidget::on_seekChanged);
     connect(
-        mDisasTextEdit,
-        &DisassemblyTextEdit::refreshContents,
+        mDisasTextView,
+        &DisassemblyTextView::refreshContents,
         this,
         &DisassemblyWidget::on_refreshContents);
 
@@ -221,7 +194,7 @@ DisassemblyWidget::DisassemblyWidget(MainWindow *main)
 
 void DisassemblyWidget::setPreviewMode(bool previewMode)
 {
-    mDisasTextEdit->setContextMenuPolicy(previewMode ? Qt::NoContextMenu : Qt::CustomContextMenu);
+    mDisasTextView->setContextMenuPolicy(previewMode ? Qt::NoContextMenu : Qt::CustomContextMenu);
     mCtxMenu->setEnabled(!previewMode);
     for (auto action : mCtxMenu->actions()) {
         action->setEnabled(!previewMode);
@@ -238,7 +211,7 @@ void DisassemblyWidget::setPreviewMode(bool previewMode)
 
 QWidget *DisassemblyWidget::getTextWidget()
 {
-    return mDisasTextEdit;
+    return mDisasTextView;
 }
 
 QString DisassemblyWidget::getWidgetType()
@@ -248,7 +221,7 @@ QString DisassemblyWidget::getWidgetType()
 
 QFontMetrics DisassemblyWidget::getFontMetrics()
 {
-    return mDisasTextEdit->fontMetrics();
+    return mDisasTextView->fontMetrics();
 }
 
 QList<DisassemblyLine> DisassemblyWidget::getLines()
@@ -265,10 +238,13 @@ void DisassemblyWidget::refreshIfInRange(RVA offset)
 
 void DisassemblyWidget::refreshDisasm(RVA offset)
 {
+    int scrolled = scrolledInstructions;
+    scrolledInstructions = 0;
     if (!disasmRefresh->attemptRefresh(offset == RVA_INVALID ? nullptr : new RVA(offset))) {
         return;
     }
 
+    RVA previousTopOffset = topOffset;
     if (offset != RVA_INVALID) {
         topOffset = offset;
     }
@@ -279,42 +255,39 @@ void DisassemblyWidget::refreshDisasm(RVA offset)
 
     if (maxLines <= 0) {
         connectCursorPositionChanged(true);
-        mDisasTextEdit->clear();
+        mDisasTextView->setRows({});
         connectCursorPositionChanged(false);
         return;
     }
 
     breakpoints = Core()->getBreakpointsAddresses();
-    int horizontalScrollValue = mDisasTextEdit->horizontalScrollBar()->value();
-    mDisasTextEdit->setLockScroll(true); // avoid flicker
 
     // Retrieve disassembly lines
     {
         TempConfig tempConfig;
         tempConfig.set("scr.color", COLOR_MODE_16M).set("asm.lines", false);
-        lines = Core()->disassembleLines(topOffset, maxLines);
+        if (!scrolled || !updateScrolledLines(previousTopOffset, scrolled)) {
+            lines = Core()->disassembleLines(topOffset, maxLines);
+        }
     }
 
     connectCursorPositionChanged(true);
 
-    mDisasTextEdit->document()->clear();
-    QTextCursor cursor(mDisasTextEdit->document());
-    QTextBlockFormat regular = cursor.blockFormat();
+    QVector<DisassemblyTextView::Row> rows;
+    rows.reserve(maxLines);
     for (const DisassemblyLine &line : lines) {
-        if (line.offset < topOffset) { // overflow
+        if (line.offset < topOffset || rows.size() >= maxLines) { // overflow
             break;
         }
-        cursor.insertHtml(line.text);
-        if (Core()->isBreakpoint(breakpoints, line.offset)) {
-            QTextBlockFormat f;
-            f.setBackground(ConfigColor("gui.breakpoint_background"));
-            cursor.setBlockFormat(f);
-        }
-        auto a = new DisassemblyTextBlockUserData(line);
-        cursor.block().setUserData(a);
-        cursor.insertBlock();
-        cursor.setBlockFormat(regular);
+        DisassemblyTextView::Row row;
+        row.text = DisassemblyTokenizer::richText(line.text);
+        row.plainText = line.text.plain;
+        row.tokens = line.text.tokens;
+        row.offset = line.offset;
+        row.breakpoint = Core()->isBreakpoint(breakpoints, line.offset);
+        rows << row;
     }
+    mDisasTextView->setRows(rows);
 
     if (!lines.isEmpty()) {
         bottomOffset = lines[qMin(lines.size(), maxLines) - 1].offset;
@@ -329,16 +302,7 @@ void DisassemblyWidget::refreshDisasm(RVA offset)
 
     updateCursorPosition();
 
-    // remove additional lines
-    QTextCursor tc = mDisasTextEdit->textCursor();
-    tc.movePosition(QTextCursor::Start);
-    tc.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor, maxLines - 1);
-    tc.movePosition(QTextCursor::EndOfLine);
-    tc.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
-    tc.removeSelectedText();
-
-    mDisasTextEdit->setLockScroll(false);
-    mDisasTextEdit->horizontalScrollBar()->setValue(horizontalScrollValue);
+    updateHorizontalScrollRange();
 
     // Refresh the left panel (trigger paintEvent)
     leftPanel->update();
@@ -363,12 +327,71 @@ void DisassemblyWidget::scrollInstructions(int count)
         }
     }
 
+    scrolledInstructions = count;
     refreshDisasm(offset);
 }
 
+bool DisassemblyWidget::updateScrolledLines(RVA previousTopOffset, int count)
+{
+    if (lines.isEmpty() || topOffset == previousTopOffset) {
+        return false;
+    }
+    QList<DisassemblyLine> scrolledLines;
+    if (count > 0) {
+        int keepFrom = 0;
+        while (keepFrom < lines.size() && lines[keepFrom].offset != topOffset) {
+            keepFrom++;
+        }
+        RVA lastOffset = lines.last().offset;
+        if (keepFrom == lines.size() || lastOffset < topOffset) {
+            return false;
+        }
+        scrolledLines = lines.mid(keepFrom);
+        while (!scrolledLines.isEmpty() && scrolledLines.last().offset == lastOffset) {
+            scrolledLines.removeLast();
+        }
+        // Disassemble again from the last instruction on, so the new ones
+        // follow it the same way a full refresh would
+        int missing = qMax(count, maxLines - int(scrolledLines.size()));
+        auto newLines = Core()->disassembleLines(lastOffset, missing + 1);
+        if (newLines.isEmpty() || newLines.first().offset != lastOffset) {
+            return false;
+        }
+        scrolledLines.append(newLines);
+    } else {
+        auto newLines = Core()->disassembleLines(topOffset, 1 - count);
+        int join = 0;
+        while (join < newLines.size() && newLines[join].offset != previousTopOffset) {
+            if (newLines[join].offset < topOffset || newLines[join].offset > previousTopOffset) {
+                return false;
+            }
+            join++;
+        }
+        // Disassembling from the new top has to end on the old one
+        if (join == newLines.size()) {
+            return false;
+        }
+        scrolledLines = newLines.mid(0, join) + lines;
+        // Drop whole instructions at the bottom that went out of view
+        while (scrolledLines.size() > maxLines) {
+            RVA lastOffset = scrolledLines.last().offset;
+            int lastStart = scrolledLines.size() - 1;
+            while (lastStart > 0 && scrolledLines[lastStart - 1].offset == lastOffset) {
+                lastStart--;
+            }
+            if (lastStart < maxLines) {
+                break;
+            }
+            scrolledLines.erase(scrolledLines.begin() + lastStart, scrolledLines.end());
+        }
+    }
+    lines = scrolledLines;
+    return true;
+}
+
 bool DisassemblyWidget::updateMaxLines()
 {
-    int currentMaxLines = qhelpers::getMaxFullyDisplayedLines(mDisasTextEdit);
+    int currentMaxLines = mDisasTextView->fullyVisibleRows();
 
     if (currentMaxLines != maxLines) {
         maxLines = currentMaxLines;
@@ -376,22 +399,26 @@ bool DisassemblyWidget::updateMaxLines()
         return true;
     }
 
+    // The rows are the same but the width may have changed
+    updateHorizontalScrollRange();
     return false;
 }
 
-void DisassemblyWidget::highlightCurrentLine()
+void DisassemblyWidget::updateHorizontalScrollRange()
 {
-    QList<QTextEdit::ExtraSelection> extraSelections;
-    QColor highlightColor = ConfigColor("lineHighlight");
+    QScrollBar *horizontalScrollBar = mDisasScrollArea->horizontalScrollBar();
+    horizontalScrollBar->setRange(
+        0, qMax(0, mDisasTextView->contentWidth() - mDisasTextView->width()));
+    horizontalScrollBar->setPageStep(mDisasTextView->width());
+}
 
+void DisassemblyWidget::highlightCurrentLine()
+{
     // Highlight the current word
-    QTextCursor cursor = mDisasTextEdit->textCursor();
-    auto clickedCharPos = cursor.positionInBlock();
-    // Select the line (BlockUnderCursor matches a line with current
-    // implementation)
-    cursor.select(QTextCursor::BlockUnderCursor);
-    // Remove any non-breakable space from the current line
-    QString searchString = cursor.selectedText().replace("\xc2\xa0", " ");
+    int row = mDisasTextView->cursorRow();
+    auto clickedCharPos = mDisasTextView->cursorColumn();
+    const auto &rows = mDisasTextView->getRows();
+    QString searchString = row < rows.size() ? rows[row].plainText : QString();
     // Cut the line in "tokens" that can be highlighted
     static const QRegularExpression tokenRegExp(R"(\b(?<!\.)([^\s]+)\b(?!\.))");
     QRegularExpressionMatchIterator i = tokenRegExp.globalMatch(searchString);
@@ -400,94 +427,30 @@ void DisassemblyWidget::highlightCurrentLine()
         // Current token is under our cursor, select this one
         if (match.capturedStart() <= clickedCharPos && match.capturedEnd() > clickedCharPos) {
             curHighlightedWord = match.captured();
+            curHighlightedType = mDisasTextView->tokenType(row, match.capturedStart());
             break;
         }
     }
 
-    // Highlight the current line
-    QTextEdit::ExtraSelection highlightSelection;
-    highlightSelection.cursor = cursor;
-    highlightSelection.cursor.movePosition(QTextCursor::Start);
-    while (true) {
-        RVA lineOffset = readDisassemblyOffset(highlightSelection.cursor);
-        if (lineOffset == seekable->getOffset()) {
-            highlightSelection.format.setBackground(highlightColor);
-            highlightSelection.format.setProperty(QTextFormat::FullWidthSelection, true);
-            highlightSelection.cursor.clearSelection();
-            extraSelections.append(highlightSelection);
-        } else if (lineOffset != RVA_INVALID && lineOffset > seekable->getOffset()) {
-            break;
-        }
-        highlightSelection.cursor.movePosition(QTextCursor::EndOfLine);
-        if (highlightSelection.cursor.atEnd()) {
-            break;
-        }
-
-        highlightSelection.cursor.movePosition(QTextCursor::Down);
-    }
-
-    // Highlight all the words in the document same as the current one
-    extraSelections.append(createSameWordsSelections(mDisasTextEdit, curHighlightedWord));
-
-    mDisasTextEdit->setExtraSelections(extraSelections);
+    // Highlight the current line and all the words on screen same as the
+    // current one
+    mDisasTextView->setSeekOffset(seekable->getOffset());
+    mDisasTextView->setHighlightedWord(curHighlightedWord, curHighlightedType);
 }
 
 void DisassemblyWidget::highlightPCLine()
 {
-    RVA PCAddr = Core()->getProgramCounterValue();
-
-    QColor highlightPCColor = ConfigColor("highlightPC");
-
-    QList<QTextEdit::ExtraSelection> pcSelections;
-    QTextEdit::ExtraSelection highlightSelection;
-    highlightSelection.cursor = mDisasTextEdit->textCursor();
-    highlightSelection.cursor.movePosition(QTextCursor::Start);
-    if (PCAddr != RVA_INVALID) {
-        while (true) {
-            RVA lineOffset = readDisassemblyOffset(highlightSelection.cursor);
-            if (lineOffset == PCAddr) {
-                highlightSelection.format.setBackground(highlightPCColor);
-                highlightSelection.format.setProperty(QTextFormat::FullWidthSelection, true);
-                highlightSelection.cursor.clearSelection();
-                pcSelections.append(highlightSelection);
-            } else if (lineOffset != RVA_INVALID && lineOffset > PCAddr) {
-                break;
-            }
-            highlightSelection.cursor.movePosition(QTextCursor::EndOfLine);
-            if (highlightSelection.cursor.atEnd()) {
-                break;
-            }
-
-            highlightSelection.cursor.movePosition(QTextCursor::Down);
-        }
-    }
-
-    // Don't override any extraSelections already set
-    QList<QTextEdit::ExtraSelection> currentSelections = mDisasTextEdit->extraSelections();
-    currentSelections.append(pcSelections);
-
-    mDisasTextEdit->setExtraSelections(currentSelections);
+    mDisasTextView->setPCOffset(Core()->getProgramCounterValue());
 }
 
 void DisassemblyWidget::showDisasContextMenu(const QPoint &pt)
 {
-    mCtxMenu->exec(mDisasTextEdit->mapToGlobal(pt));
+    mCtxMenu->exec(mDisasTextView->mapToGlobal(pt));
 }
 
 RVA DisassemblyWidget::readCurrentDisassemblyOffset()
 {
-    QTextCursor tc = mDisasTextEdit->textCursor();
-    return readDisassemblyOffset(tc);
-}
-
-RVA DisassemblyWidget::readDisassemblyOffset(QTextCursor tc)
-{
-    auto userData = getUserData(tc.block());
-    if (!userData) {
-        return RVA_INVALID;
-    }
-
-    return userData->line.offset;
+    return mDisasTextView->rowOffset(mDisasTextView->cursorRow());
 }
 
 void DisassemblyWidget::updateCursorPosition()
@@ -503,50 +466,24 @@ void DisassemblyWidget::updateCursorPosition()
     connectCursorPositionChanged(true);
 
     if (offset < topOffset || (offset > bottomOffset && bottomOffset != RVA_INVALID)) {
-        mDisasTextEdit->moveCursor(QTextCursor::Start);
-        mDisasTextEdit->setExtraSelections(
-            createSameWordsSelections(mDisasTextEdit, curHighlightedWord));
+        mDisasTextView->setCursorPosition(0, 0);
+        mDisasTextView->setSeekOffset(offset);
+        mDisasTextView->setHighlightedWord(curHighlightedWord, curHighlightedType);
     } else {
-        RVA currentCursorOffset = readCurrentDisassemblyOffset();
-        QTextCursor originalCursor = mDisasTextEdit->textCursor();
-
-        QTextCursor cursor = originalCursor;
-        cursor.movePosition(QTextCursor::Start);
-
-        while (true) {
-            RVA lineOffset = readDisassemblyOffset(cursor);
+        const auto &rows = mDisasTextView->getRows();
+        for (int row = 0; row < rows.size(); row++) {
+            RVA lineOffset = rows[row].offset;
             if (lineOffset == offset) {
-                if (cursorLineOffset > 0) {
-                    cursor.movePosition(QTextCursor::Down, QTextCursor::MoveAnchor, cursorLineOffset);
-                }
-                if (cursorCharOffset > 0) {
-                    cursor.movePosition(QTextCursor::StartOfLine);
-                    cursor
-                        .movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, cursorCharOffset);
-                }
-
-                mDisasTextEdit->setTextCursor(cursor);
+                mDisasTextView->setCursorPosition(
+                    qMin(row + cursorLineOffset, int(rows.size()) - 1), cursorCharOffset);
                 highlightCurrentLine();
                 break;
             } else if (lineOffset != RVA_INVALID && lineOffset > offset) {
-                mDisasTextEdit->moveCursor(QTextCursor::Start);
-                mDisasTextEdit->setExtraSelections({});
+                mDisasTextView->setCursorPosition(0, 0);
+                mDisasTextView->setSeekOffset(offset);
+                mDisasTextView->setHighlightedWord(QString());
                 break;
             }
-
-            cursor.movePosition(QTextCursor::EndOfLine);
-            if (cursor.atEnd()) {
-                break;
-            }
-
-            cursor.movePosition(QTextCursor::Down);
-        }
-
-        // this is true if a seek came from the user clicking on a line.
-        // then the cursor should be restored 1:1 to retain selection and cursor
-        // position.
-        if (currentCursorOffset == offset) {
-            mDisasTextEdit->setTextCursor(originalCursor);
         }
     }
 
@@ -559,14 +496,14 @@ void DisassemblyWidget::connectCursorPositionChanged(bool disconnect)
 {
     if (disconnect) {
         QObject::disconnect(
-            mDisasTextEdit,
-            &QPlainTextEdit::cursorPositionChanged,
+            mDisasTextView,
+            &DisassemblyTextView::cursorPositionChanged,
             this,
             &DisassemblyWidget::cursorPositionChanged);
     } else {
         connect(
-            mDisasTextEdit,
-            &QPlainTextEdit::cursorPositionChanged,
+            mDisasTextView,
+            &DisassemblyTextView::cursorPositionChanged,
             this,
             &DisassemblyWidget::cursorPositionChanged);
     }
@@ -577,13 +514,9 @@ void DisassemblyWidget::cursorPositionChanged()
     RVA offset = readCurrentDisassemblyOffset();
 
     cursorLineOffset = 0;
-    QTextCursor c = mDisasTextEdit->textCursor();
-    cursorCharOffset = c.positionInBlock();
-    while (c.blockNumber() > 0) {
-        c.movePosition(QTextCursor::PreviousBlock);
-        if (readDisassemblyOffset(c) != offset) {
-            break;
-        }
+    cursorCharOffset = mDisasTextView->cursorColumn();
+    const auto &rows = mDisasTextView->getRows();
+    for (int row = mDisasTextView->cursorRow() - 1; row >= 0 && rows[row].offset == offset; row--) {
         cursorLineOffset++;
     }
 
@@ -592,10 +525,10 @@ void DisassemblyWidget::cursorPositionChanged()
     seekFromCursor = false;
     highlightCurrentLine();
     highlightPCLine();
-    mCtxMenu->setCanCopy(mDisasTextEdit->textCursor().hasSelection());
-    if (mDisasTextEdit->textCursor().hasSelection()) {
+    mCtxMenu->setCanCopy(mDisasTextView->hasSelection());
+    if (mDisasTextView->hasSelection()) {
         // A word is selected so use it
-        mCtxMenu->setCurHighlightedWord(mDisasTextEdit->textCursor().selectedText());
+        mCtxMenu->setCurHighlightedWord(mDisasTextView->selectedText());
     } else {
         // No word is selected so use the word under the cursor
         mCtxMenu->setCurHighlightedWord(curHighlightedWord);
@@ -640,20 +573,21 @@ void DisassemblyWidget::moveCursorRelative(bool up, bool page)
         }
         refreshDisasm(offset);
     } else { // normal arrow keys
-        int blockCount = mDisasTextEdit->blockCount();
-        if (blockCount < 1) {
+        int rowCount = mDisasTextView->getRows().size();
+        if (rowCount < 1) {
             return;
         }
 
-        int blockNumber = mDisasTextEdit->textCursor().blockNumber();
+        int row = mDisasTextView->cursorRow();
 
-        if (blockNumber == blockCount - 1 && !up) {
+        if (row == rowCount - 1 && !up) {
             scrollInstructions(1);
-        } else if (blockNumber == 0 && up) {
+        } else if (row == 0 && up) {
             scrollInstructions(-1);
         }
 
-        mDisasTextEdit->moveCursor(up ? QTextCursor::Up : QTextCursor::Down);
+        mDisasTextView->setCursorPosition(
+            mDisasTextView->cursorRow() + (up ? -1 : 1), mDisasTextView->cursorColumn());
 
         // handle cases where top instruction offsets change
         RVA offset = readCurrentDisassemblyOffset();
@@ -665,33 +599,27 @@ void DisassemblyWidget::moveCursorRelative(bool up, bool page)
     }
 }
 
-void DisassemblyWidget::jumpToOffsetUnderCursor(const QTextCursor &cursor)
+void DisassemblyWidget::jumpToOffsetAtRow(int row)
 {
-    RVA offset = readDisassemblyOffset(cursor);
+    RVA offset = mDisasTextView->rowOffset(row);
     seekable->seekToReference(offset);
 }
 
 bool DisassemblyWidget::eventFilter(QObject *obj, QEvent *event)
 {
-    if (event->type() == QEvent::MouseButtonDblClick
-        && (obj == mDisasTextEdit || obj == mDisasTextEdit->viewport())) {
+    if (event->type() == QEvent::MouseButtonDblClick && obj == mDisasTextView) {
         QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
 
-        const QTextCursor &cursor = mDisasTextEdit->cursorForPosition(
-            QPoint(mouseEvent->x(), mouseEvent->y()));
-        jumpToOffsetUnderCursor(cursor);
+        jumpToOffsetAtRow(mDisasTextView->rowAt(mouseEvent->pos().y()));
 
         return true;
-    } else if (event->type() == QEvent::ToolTip && obj == mDisasTextEdit->viewport()) {
+    } else if (event->type() == QEvent::ToolTip && obj == mDisasTextView) {
         QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
 
-        auto cursorForWord = mDisasTextEdit->cursorForPosition(helpEvent->pos());
-        cursorForWord.select(QTextCursor::WordUnderCursor);
-
-        RVA offsetFrom = readDisassemblyOffset(cursorForWord);
+        RVA offsetFrom = mDisasTextView->rowOffset(mDisasTextView->rowAt(helpEvent->pos().y()));
         RVA offsetTo = RVA_INVALID;
 
-        QList<XrefDescription> refs = Core()->getXRefs(offsetFrom, false, false);
+        QList<XrefDescription> refs = Core()->getXRefs(offsetFrom, false, false, QString(), false);
 
         if (refs.length()) {
             if (refs.length() > 1) {
@@ -741,8 +669,7 @@ bool DisassemblyWidget::eventFilter(QObject *obj, QEvent *event)
 void DisassemblyWidget::keyPressEvent(QKeyEvent *event)
 {
     if (event->key() == Qt::Key_Return) {
-        const QTextCursor cursor = mDisasTextEdit->textCursor();
-        jumpToOffsetUnderCursor(cursor);
+        jumpToOffsetAtRow(mDisasTextView->cursorRow());
     }
 
     MemoryDockWidget::keyPressEvent(event);
@@ -794,14 +721,13 @@ void DisassemblyWidget::colorsUpdatedSlot()
 
 void DisassemblyWidget::setupFonts()
 {
-    mDisasTextEdit->setFont(Config()->getFont());
+    mDisasTextView->setFont(Config()->getFont());
 }
 
 void DisassemblyWidget::setupColors()
 {
-    mDisasTextEdit->setStyleSheet(QStringLiteral("QPlainTextEdit { background-color: %1; color: %2; }")
-                                      .arg(ConfigColor("gui.background").name())
-                                      .arg(ConfigColor("btext").name()));
+    // the colors are read when painting
+    mDisasTextView->update();
 }
 
 DisassemblyScrollArea::DisassemblyScrollArea(QWidget *parent)
@@ -831,59 +757,321 @@ void DisassemblyScrollArea::resetScrollBars()
     verticalScrollBar()->blockSignals(false);
 }
 
-qreal DisassemblyTextEdit::textOffset() const
+DisassemblyTextView::DisassemblyTextView(QWidget *parent)
+    : QWidget(parent)
+    , mFontMetrics(new CachedFontMetrics<qreal>(font()))
 {
-    return (blockBoundingGeometry(document()->begin()).topLeft() + contentOffset()).y();
+    setAttribute(Qt::WA_OpaquePaintEvent);
 }
 
-bool DisassemblyTextEdit::viewportEvent(QEvent *event)
+void DisassemblyTextView::setRows(const QVector<Row> &rows)
 {
-    switch (event->type()) {
-    case QEvent::Type::Wheel: {
-        QWheelEvent *wheelEvent = static_cast<QWheelEvent *>(event);
-        if (wheelEvent->modifiers() & Qt::ControlModifier) {
-            // zoom text
-            int delta = wheelEvent->angleDelta().y();
-            qreal zoomFactor = Config()->getZoomFactor();
-            zoomFactor += delta > 0 ? 0.1 : -0.1;
-            Config()->setZoomFactor(zoomFactor);
-            emit refreshContents();
-            event->accept();
-            return true;
-        } else {
-            // just scroll the disasm
-            emit refreshContents();
-            event->accept();
-            return false;
+    // Rows are matched by offset and by their distance to the last row of
+    // that offset, so lines added above an instruction don't move the cursor
+    auto rowKey = [this](const Position &position) {
+        int distance = 0;
+        if (position.row >= this->rows.size()) {
+            return qMakePair(RVA_INVALID, distance);
         }
+        RVA offset = this->rows[position.row].offset;
+        while (position.row + distance + 1 < this->rows.size()
+               && this->rows[position.row + distance + 1].offset == offset) {
+            distance++;
+        }
+        return qMakePair(offset, distance);
+    };
+    const auto cursorKey = rowKey(cursor);
+    const auto anchorKey = rowKey(anchor);
+    const Position oldCursor = cursor;
+    const Position oldAnchor = anchor;
+
+    this->rows = rows;
+    instructionRows.clear();
+    for (int i = 0; i < rows.size(); i++) {
+        instructionRows.insert(rows[i].offset, i);
     }
-    default:
-        return QAbstractScrollArea::viewportEvent(event);
+
+    auto mapPosition = [this](const QPair<RVA, int> &key, const Position &position, bool *ok) {
+        Position mapped;
+        int row = instructionRow(key.first) - key.second;
+        *ok = key.first != RVA_INVALID && row >= 0 && this->rows[row].offset == key.first;
+        if (*ok) {
+            mapped.row = row;
+            mapped.column = qMin(position.column, int(this->rows[row].plainText.size()));
+        }
+        return mapped;
+    };
+    bool cursorMapped;
+    bool anchorMapped;
+    cursor = mapPosition(cursorKey, oldCursor, &cursorMapped);
+    anchor = mapPosition(anchorKey, oldAnchor, &anchorMapped);
+    // Drop the selection when one of its ends went out of view
+    if (!cursorMapped || !anchorMapped) {
+        anchor = cursor;
     }
+    updateTextWidth();
+    update();
+}
+
+RVA DisassemblyTextView::rowOffset(int row) const
+{
+    return row >= 0 && row < rows.size() ? rows[row].offset : RVA_INVALID;
 }
 
-void DisassemblyTextEdit::scrollContentsBy(int dx, int dy)
+int DisassemblyTextView::rowAt(int y) const
 {
-    if (!lockScroll) {
-        QPlainTextEdit::scrollContentsBy(dx, dy);
+    if (rows.isEmpty()) {
+        return -1;
     }
+    return qBound(0, (y - MARGIN) / rowHeight(), int(rows.size()) - 1);
 }
 
-void DisassemblyTextEdit::keyPressEvent(QKeyEvent *event)
+int DisassemblyTextView::rowCenter(int row) const
 {
-    Q_UNUSED(event)
-    // QPlainTextEdit::keyPressEvent(event);
+    return MARGIN + row * rowHeight() + rowHeight() / 2;
+}
+
+int DisassemblyTextView::rowHeight() const
+{
+    return qMax(1, qRound(mFontMetrics->height()));
+}
+
+int DisassemblyTextView::fullyVisibleRows() const
+{
+    return qMax(0, (height() - 2 * MARGIN) / rowHeight());
+}
+
+int DisassemblyTextView::contentWidth() const
+{
+    return int(std::ceil(textWidth)) + 2 * MARGIN;
+}
+
+void DisassemblyTextView::setCursorPosition(int row, int column, bool keepAnchor)
+{
+    Position position;
+    if (!rows.isEmpty()) {
+        position.row = qBound(0, row, int(rows.size()) - 1);
+        position.column = qBound(0, column, int(rows[position.row].plainText.size()));
+    }
+    if (position == cursor && (keepAnchor || anchor == cursor)) {
+        return;
+    }
+    cursor = position;
+    if (!keepAnchor) {
+        anchor = position;
+    }
+    update();
+    emit cursorPositionChanged();
+}
+
+bool DisassemblyTextView::hasSelection() const
+{
+    return !(anchor == cursor);
+}
+
+QString DisassemblyTextView::selectedText() const
+{
+    if (!hasSelection()) {
+        return QString();
+    }
+    const Position from = qMin(anchor, cursor);
+    const Position to = qMax(anchor, cursor);
+    QStringList parts;
+    for (int row = from.row; row <= to.row; row++) {
+        const QString &text = rows[row].plainText;
+        int start = row == from.row ? from.column : 0;
+        int end = row == to.row ? to.column : int(text.size());
+        parts << text.mid(start, end - start);
+    }
+    return parts.join(QLatin1Char('\n'));
+}
+
+DisassemblyToken::Type DisassemblyTextView::tokenType(int row, int column) const
+{
+    if (row < 0 || row >= rows.size()) {
+        return DisassemblyToken::Type::Text;
+    }
+    for (const DisassemblyToken &token : rows[row].tokens) {
+        if (column >= token.start && column < token.start + token.length) {
+            return token.type;
+        }
+    }
+    return DisassemblyToken::Type::Text;
+}
+
+void DisassemblyTextView::setHighlightedWord(const QString &word, DisassemblyToken::Type type)
+{
+    if (word == highlightedWord && type == highlightedType) {
+        return;
+    }
+    highlightedWord = word;
+    highlightedType = type;
+    highlightedWordRegExp = QRegularExpression(
+        QStringLiteral("(?<!\\w)%1(?!\\w)").arg(QRegularExpression::escape(word)),
+        QRegularExpression::CaseInsensitiveOption);
+    update();
 }
 
-void DisassemblyTextEdit::mousePressEvent(QMouseEvent *event)
+void DisassemblyTextView::setSeekOffset(RVA offset)
 {
-    QPlainTextEdit::mousePressEvent(event);
+    if (offset != seekOffset) {
+        seekOffset = offset;
+        update();
+    }
+}
 
-    if (event->button() == Qt::RightButton && !textCursor().hasSelection()) {
-        setTextCursor(cursorForPosition(event->pos()));
+void DisassemblyTextView::setPCOffset(RVA offset)
+{
+    if (offset != pcOffset) {
+        pcOffset = offset;
+        update();
     }
 }
 
+void DisassemblyTextView::setHorizontalOffset(int offset)
+{
+    horizontalOffset = offset;
+    update();
+}
+
+void DisassemblyTextView::copy()
+{
+    if (hasSelection()) {
+        QApplication::clipboard()->setText(selectedText());
+    }
+}
+
+void DisassemblyTextView::paintEvent(QPaintEvent *event)
+{
+    QPainter p(this);
+    p.fillRect(event->rect(), ConfigColor("gui.background"));
+    if (rows.isEmpty()) {
+        return;
+    }
+
+    const QColor breakpointColor = ConfigColor("gui.breakpoint_background");
+    const QColor lineColor = ConfigColor("lineHighlight");
+    const QColor pcColor = ConfigColor("highlightPC");
+    const QColor wordColor = ConfigColor("wordHighlight");
+    const QColor selectionColor = palette().color(QPalette::Highlight);
+    const Position from = qMin(anchor, cursor);
+    const Position to = qMax(anchor, cursor);
+    const qreal h = rowHeight();
+    const qreal x = MARGIN - horizontalOffset;
+
+    const int last = rowAt(event->rect().bottom());
+    for (int i = rowAt(event->rect().top()); i <= last; i++) {
+        const Row &row = rows[i];
+        const qreal y = MARGIN + i * h;
+        const QRectF line(0, y, width(), h);
+
+        // Later highlights are painted over the earlier ones
+        if (row.breakpoint) {
+            p.fillRect(line, breakpointColor);
+        }
+        if (row.offset == seekOffset) {
+            p.fillRect(line, lineColor);
+        }
+        if (!highlightedWord.isEmpty()) {
+            QRegularExpressionMatchIterator it = highlightedWordRegExp.globalMatch(row.plainText);
+            while (it.hasNext()) {
+                QRegularExpressionMatch match = it.next();
+                if (highlightedType != DisassemblyToken::Type::Text
+                    && tokenType(i, match.capturedStart()) != highlightedType) {
+                    continue;
+                }
+                qreal start = columnX(i, match.capturedStart());
+                qreal end = columnX(i, match.capturedEnd());
+                p.fillRect(QRectF(x + start, y, end - start, h), wordColor);
+            }
+        }
+        if (row.offset == pcOffset) {
+            p.fillRect(line, pcColor);
+        }
+        if (hasSelection() && i >= from.row && i <= to.row) {
+            qreal start = i == from.row ? columnX(i, from.column) : 0;
+            qreal end = i == to.row ? columnX(i, to.column) : columnX(i, row.plainText.size());
+            p.fillRect(QRectF(x + start, y, end - start, h), selectionColor);
+        }
+
+        RichTextPainter::paintRichText<qreal>(
+            &p, x, y, width() - x, h, 0, row.text, mFontMetrics.get());
+    }
+}
+
+void DisassemblyTextView::changeEvent(QEvent *event)
+{
+    if (event->type() == QEvent::FontChange) {
+        mFontMetrics.reset(new CachedFontMetrics<qreal>(font()));
+        updateTextWidth();
+        update();
+    }
+    QWidget::changeEvent(event);
+}
+
+void DisassemblyTextView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        Position position = positionAt(event->pos());
+        setCursorPosition(
+            position.row, position.column, event->modifiers().testFlag(Qt::ShiftModifier));
+    } else if (event->button() == Qt::RightButton && !hasSelection()) {
+        Position position = positionAt(event->pos());
+        setCursorPosition(position.row, position.column);
+    }
+}
+
+void DisassemblyTextView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (event->buttons() & Qt::LeftButton) {
+        Position position = positionAt(event->pos());
+        setCursorPosition(position.row, position.column, true);
+    }
+}
+
+void DisassemblyTextView::wheelEvent(QWheelEvent *event)
+{
+    if (event->modifiers() & Qt::ControlModifier) {
+        // zoom text
+        int delta = event->angleDelta().y();
+        qreal zoomFactor = Config()->getZoomFactor();
+        zoomFactor += delta > 0 ? 0.1 : -0.1;
+        Config()->setZoomFactor(zoomFactor);
+        emit refreshContents();
+        event->accept();
+        return;
+    }
+    // let the scroll area scroll the disasm
+    emit refreshContents();
+    event->ignore();
+}
+
+void DisassemblyTextView::updateTextWidth()
+{
+    textWidth = 0;
+    for (const Row &row : std::as_const(rows)) {
+        textWidth = qMax(textWidth, mFontMetrics->width(row.plainText));
+    }
+}
+
+DisassemblyTextView::Position DisassemblyTextView::positionAt(const QPoint &pos) const
+{
+    Position position;
+    if (rows.isEmpty()) {
+        return position;
+    }
+    position.row = rowAt(pos.y());
+    const QString &text = rows[position.row].plainText;
+    int column = mFontMetrics->position(text, pos.x() - MARGIN + horizontalOffset);
+    position.column = column < 0 ? int(text.size()) : column;
+    return position;
+}
+
+qreal DisassemblyTextView::columnX(int row, int column) const
+{
+    return mFontMetrics->width(rows[row].plainText.left(column));
+}
+
 void DisassemblyWidget::seekPrev()
 {
     Core()->seekPrev();
@@ -932,26 +1120,26 @@ void DisassemblyLeftPanel::paintEvent(QPaintEvent *event)
     constexpr int distanceBetweenLines = 10;
     constexpr int arrowWidth = 5;
     int rightOffset = size().rwidth();
-    auto tEdit = qobject_cast<DisassemblyTextEdit *>(disas->getTextWidget());
-    int topOffset = int(tEdit->contentsMargins().top() + tEdit->textOffset());
-    int lineHeight = disas->getFontMetrics().height();
+    auto view = qobject_cast<DisassemblyTextView *>(disas->getTextWidget());
     QColor arrowColorDown = ConfigColor("flow");
     QColor arrowColorUp = ConfigColor("cflow");
     QPainter p(this);
     QPen penDown(arrowColorDown, penSizePix, Qt::SolidLine, Qt::FlatCap, Qt::RoundJoin);
     QPen penUp(arrowColorUp, penSizePix, Qt::SolidLine, Qt::FlatCap, Qt::RoundJoin);
     // Fill background
-    p.fillRect(event->rect(), Config()->getColor("gui.background").darker(115));
+    p.fillRect(event->rect(), ConfigColor("gui.background").darker(115));
 
     QList<DisassemblyLine> lines = disas->getLines();
 
-    QMap<RVA, int> linesPixPosition;
+    // Vertical center of the instruction at offset, -1 if it is not shown
+    auto lineY = [view](RVA offset) {
+        int row = view->instructionRow(offset);
+        return row < 0 ? -1 : view->rowCenter(row);
+    };
+
     QMap<RVA, pair<RVA, int>> arrowInfo; /* offset -> (arrow, layer of arrow) */
-    int nLines = 0;
     for (const auto &line : lines) {
-        linesPixPosition[line.offset] = nLines * lineHeight + lineHeight / 2 + topOffset;
-        nLines++;
-        if (line.arrow != RVA_INVALID) {
+        if (line.arrow != RVA_INVALID && lineY(line.offset) != -1) {
             arrowInfo.insert(line.offset, {line.arrow, -1});
         }
     }
@@ -1007,12 +1195,12 @@ void DisassemblyLeftPanel::paintEvent(QPaintEvent *event)
     qreal pixelRatio = qhelpers::devicePixelRatio(p.device());
     // Draw the lines
     for (const auto &l : lines) {
-        int lineOffset = int(
-            (distanceBetweenLines * arrowInfo[l.offset].second + distanceBetweenLines) * pixelRatio);
-        // Skip until we reach a line that jumps to a destination
-        if (l.arrow == RVA_INVALID) {
+        // Skip until we reach a shown line that jumps to a destination
+        if (l.arrow == RVA_INVALID || !arrowInfo.contains(l.offset)) {
             continue;
         }
+        int lineOffset = int(
+            (distanceBetweenLines * arrowInfo[l.offset].second + distanceBetweenLines) * pixelRatio);
 
         bool jumpDown = l.arrow > l.offset;
         p.setPen(jumpDown ? penDown : penUp);
@@ -1023,8 +1211,8 @@ void DisassemblyLeftPanel::paintEvent(QPaintEvent *event)
         }
         bool endVisible = true;
 
-        int currentLineYPos = linesPixPosition[l.offset];
-        int lineArrowY = linesPixPosition.value(l.arrow, -1);
+        int currentLineYPos = lineY(l.offset);
+        int lineArrowY = lineY(l.arrow);
 
         if (lineArrowY == -1) {
             lineArrowY = jumpDown ? geometry().bottom() : 0;
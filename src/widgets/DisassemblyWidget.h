@@ -5,14 +5,20 @@
 #include "common/CachedFontMetrics.h"
 #include "common/IaitoSeekable.h"
 #include "common/RefreshDeferrer.h"
+#include "common/RichTextPainter.h"
 #include "core/Iaito.h"
 
+#include <QAbstractScrollArea>
 #include <QAction>
-#include <QPlainTextEdit>
+#include <QFrame>
+#include <QHash>
+#include <QRegularExpression>
 #include <QShortcut>
-#include <QTextEdit>
+#include <QVector>
 
-class DisassemblyTextEdit;
+#include <memory>
+
+class DisassemblyTextView;
 class DisassemblyScrollArea;
 class DisassemblyContextMenu;
 class DisassemblyLeftPanel;
@@ -61,7 +67,7 @@ protected slots:
 protected:
     DisassemblyContextMenu *mCtxMenu;
     DisassemblyScrollArea *mDisasScrollArea;
-    DisassemblyTextEdit *mDisasTextEdit;
+    DisassemblyTextView *mDisasTextView;
     DisassemblyLeftPanel *leftPanel;
     QList<DisassemblyLine> lines;
 
@@ -71,6 +77,7 @@ private:
     int maxLines;
 
     QString curHighlightedWord;
+    DisassemblyToken::Type curHighlightedType = DisassemblyToken::Type::Text;
 
     /**
      * offset of lines below the first line of the current seek
@@ -80,9 +87,13 @@ private:
     bool seekFromCursor;
 
     RefreshDeferrer *disasmRefresh;
+    /**
+     * instructions scrolled by the pending refreshDisasm(), lines on screen
+     * can be reused if not 0
+     */
+    int scrolledInstructions = 0;
 
     RVA readCurrentDisassemblyOffset();
-    RVA readDisassemblyOffset(QTextCursor tc);
     bool eventFilter(QObject *obj, QEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     QString getWindowTitle() const override;
@@ -96,9 +107,22 @@ private:
 
     void connectCursorPositionChanged(bool disconnect);
 
+    /**
+     * @brief Update lines after scrolling by count instructions from
+     * previousTopOffset to topOffset, disassembling only the instructions
+     * that came into view.
+     * @return false if the lines have to be fetched again entirely
+     */
+    bool updateScrolledLines(RVA previousTopOffset, int count);
+
     void moveCursorRelative(bool up, bool page);
 
-    void jumpToOffsetUnderCursor(const QTextCursor &);
+    /**
+     * @brief Fit the horizontal scroll range to the rows and the view width
+     */
+    void updateHorizontalScrollRange();
+
+    void jumpToOffsetAtRow(int row);
 };
 
 class DisassemblyScrollArea : public QAbstractScrollArea
@@ -119,32 +143,125 @@ private:
     void resetScrollBars();
 };
 
-class DisassemblyTextEdit : public QPlainTextEdit
+/**
+ * @brief Paints the disassembly rows as runs of colored text.
+ *
+ * Rows are built from the cached tokens of the DisassemblyTokenizer, so a
+ * refresh after scrolling only tokenizes the lines that came into view and
+ * painting never lays out a document. The
+ * cursor, the selection and the highlights are kept as row and column
+ * positions.
+ */
+class DisassemblyTextView : public QWidget
 {
     Q_OBJECT
 
 public:
-    explicit DisassemblyTextEdit(QWidget *parent = nullptr)
-        : QPlainTextEdit(parent)
-        , lockScroll(false)
-    {}
+    struct Row
+    {
+        RVA offset = RVA_INVALID;
+        RichTextPainter::List text;
+        QString plainText;
+        // typed runs of plainText
+        QVector<DisassemblyToken> tokens;
+        bool breakpoint = false;
+    };
+
+    explicit DisassemblyTextView(QWidget *parent = nullptr);
+
+    /**
+     * @brief Replace the rows, the cursor and the selection stay on the
+     * same addresses, or move to the first row if those are gone
+     */
+    void setRows(const QVector<Row> &rows);
+    const QVector<Row> &getRows() const { return rows; }
+    RVA rowOffset(int row) const;
+    /**
+     * @return row of the instruction at offset, which comes after the rows of
+     * its flags and comments, -1 if it is not shown
+     */
+    int instructionRow(RVA offset) const { return instructionRows.value(offset, -1); }
+    /**
+     * @return row at y, clamped to the existing rows, -1 if there are none
+     */
+    int rowAt(int y) const;
+    int rowCenter(int row) const;
+    int rowHeight() const;
+    int fullyVisibleRows() const;
+    int contentWidth() const;
+
+    int cursorRow() const { return cursor.row; }
+    int cursorColumn() const { return cursor.column; }
+    void setCursorPosition(int row, int column, bool keepAnchor = false);
+    bool hasSelection() const;
+    QString selectedText() const;
 
-    void setLockScroll(bool lock) { this->lockScroll = lock; }
+    /**
+     * @return type of the token at column of row, Text if there is none
+     */
+    DisassemblyToken::Type tokenType(int row, int column) const;
 
-    qreal textOffset() const;
+    /**
+     * @brief Highlight every occurrence of word as a whole word, only in the
+     * tokens of type unless it is Text, so a register is not highlighted in
+     * the comments
+     */
+    void setHighlightedWord(
+        const QString &word, DisassemblyToken::Type type = DisassemblyToken::Type::Text);
+    void setSeekOffset(RVA offset);
+    void setPCOffset(RVA offset);
+
+public slots:
+    void setHorizontalOffset(int offset);
+    void copy();
 
-public:
 signals:
+    void cursorPositionChanged();
     void refreshContents();
 
 protected:
-    bool viewportEvent(QEvent *event) override;
-    void scrollContentsBy(int dx, int dy) override;
-    void keyPressEvent(QKeyEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void changeEvent(QEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
 
 private:
-    bool lockScroll;
+    static constexpr int MARGIN = 10;
+
+    struct Position
+    {
+        int row = 0;
+        int column = 0;
+
+        bool operator==(const Position &other) const
+        {
+            return row == other.row && column == other.column;
+        }
+        bool operator<(const Position &other) const
+        {
+            return row < other.row || (row == other.row && column < other.column);
+        }
+    };
+
+    QVector<Row> rows;
+    QHash<RVA, int> instructionRows;
+    std::unique_ptr<CachedFontMetrics<qreal>> mFontMetrics;
+    qreal textWidth = 0;
+    int horizontalOffset = 0;
+
+    Position cursor;
+    Position anchor;
+
+    QString highlightedWord;
+    DisassemblyToken::Type highlightedType = DisassemblyToken::Type::Text;
+    QRegularExpression highlightedWordRegExp;
+    RVA seekOffset = RVA_INVALID;
+    RVA pcOffset = RVA_INVALID;
+
+    void updateTextWidth();
+    Position positionAt(const QPoint &pos) const;
+    qreal columnX(int row, int column) const;
 };
 
 /**
@@ -1,5 +1,6 @@
 #include "ExportsWidget.h"
 #include "WidgetShortcuts.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_ListDockWidget.h"
@@ -40,7 +41,7 @@ QVariant ExportsModel::data(const QModelIndex &index, int role) const
         case ExportsModel::NameColumn:
             return exp.name;
         case ExportsModel::CommentColumn:
-            return Core()->getCommentAt(exp.vaddr);
+            return Core()->getCommentCache()->at(exp.vaddr);
         default:
             return QVariant();
         }
@@ -121,7 +122,8 @@ bool ExportsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &rig
             return leftExp.type < rightExp.type;
         break;
     case ExportsModel::CommentColumn:
-        return Core()->getCommentAt(leftExp.vaddr) < Core()->getCommentAt(rightExp.vaddr);
+        return Core()->getCommentCache()->at(leftExp.vaddr)
+               < Core()->getCommentCache()->at(rightExp.vaddr);
     default:
         break;
     }
@@ -1,4 +1,5 @@
 #include "FlagsWidget.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_FlagsWidget.h"
@@ -44,7 +45,7 @@ QVariant FlagsModel::data(const QModelIndex &index, int role) const
         case REALNAME:
             return flag.realname;
         case COMMENT:
-            return Core()->getCommentAt(flag.offset);
+            return Core()->getCommentCache()->at(flag.offset);
         default:
             return QVariant();
         }
@@ -136,7 +137,8 @@ bool FlagsSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelIn
         return left_flag->realname < right_flag->realname;
 
     case FlagsModel::COMMENT:
-        return Core()->getCommentAt(left_flag->offset) < Core()->getCommentAt(right_flag->offset);
+        return Core()->getCommentCache()->at(left_flag->offset)
+               < Core()->getCommentCache()->at(right_flag->offset);
 
     default:
         break;
@@ -1,19 +1,24 @@
 #include "FunctionsWidget.h"
 #include "ui_ListDockWidget.h"
 
+#include "common/CommentCache.h"
+#include "common/DecompileExportTask.h"
 #include "common/FunctionsTask.h"
 #include "common/Helpers.h"
 #include "common/TempConfig.h"
 #include "core/MainWindow.h"
+#include "dialogs/AsyncTaskDialog.h"
 #include "menus/AddressableItemContextMenu.h"
 
 #include <algorithm>
 #include <QActionGroup>
 #include <QDebug>
+#include <QFileDialog>
 #include <QInputDialog>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QMenu>
+#include <QMessageBox>
 #include <QResource>
 #include <QShortcut>
 #include <QString>
@@ -147,7 +152,7 @@ QVariant FunctionModel::data(const QModelIndex &index, int role) const
                 case 8:
                     return tr("StackFrame: %1").arg(function.stackframe);
                 case 9:
-                    return tr("Comment: %1").arg(Core()->getCommentAt(function.offset));
+                    return tr("Comment: %1").arg(Core()->getCommentCache()->at(function.offset));
                 default:
                     return QVariant();
                 }
@@ -175,7 +180,7 @@ QVariant FunctionModel::data(const QModelIndex &index, int role) const
             case FrameColumn:
                 return QString::number(function.stackframe);
             case CommentColumn:
-                return Core()->getCommentAt(function.offset);
+                return Core()->getCommentCache()->at(function.offset);
             default:
                 return QVariant();
             }
@@ -348,7 +353,7 @@ bool FunctionModel::updateCurrentIndex()
     for (int i = 0; i < functions->count(); i++) {
         const FunctionDescription &function = functions->at(i);
 
-        if (function.contains(Core()->core()->anal, seek) && function.offset >= offset) {
+        if (function.contains(Core()->coreRead()->anal, seek) && function.offset >= offset) {
             offset = function.offset;
             index = i;
         }
@@ -445,8 +450,8 @@ bool FunctionSortFilterProxyModel::lessThan(const QModelIndex &left, const QMode
                 return left_function.stackframe < right_function.stackframe;
             break;
         case FunctionModel::CommentColumn:
-            return Core()->getCommentAt(left_function.offset)
-                   < Core()->getCommentAt(right_function.offset);
+            return Core()->getCommentCache()->at(left_function.offset)
+                   < Core()->getCommentCache()->at(right_function.offset);
         default:
             return false;
         }
@@ -459,6 +464,8 @@ FunctionsWidget::FunctionsWidget(MainWindow *main)
     : ListDockWidget(main)
     , actionRename(tr("Rename"), this)
     , actionUndefine(tr("Undefine"), this)
+    , actionDecompileSelected(tr("Decompile to Directory..."), this)
+    , actionDecompileAll(tr("Decompile All to Directory..."), this)
     , actionHorizontal(tr("Horizontal"), this)
     , actionVertical(tr("Vertical"), this)
 {
@@ -500,11 +507,24 @@ FunctionsWidget::FunctionsWidget(MainWindow *main)
         &QAction::triggered,
         this,
         &FunctionsWidget::onActionFunctionsUndefineTriggered);
+    connect(
+        &actionDecompileSelected,
+        &QAction::triggered,
+        this,
+        &FunctionsWidget::onActionDecompileSelectedTriggered);
+    connect(
+        &actionDecompileAll,
+        &QAction::triggered,
+        this,
+        &FunctionsWidget::onActionDecompileAllTriggered);
 
     auto itemConextMenu = ui->treeView->getItemContextMenu();
     itemConextMenu->addSeparator();
     itemConextMenu->addAction(&actionRename);
     itemConextMenu->addAction(&actionUndefine);
+    itemConextMenu->addSeparator();
+    itemConextMenu->addAction(&actionDecompileSelected);
+    itemConextMenu->addAction(&actionDecompileAll);
     itemConextMenu->setWholeFunction(true);
 
     addActions(itemConextMenu->actions());
@@ -617,6 +637,71 @@ void FunctionsWidget::onActionFunctionsUndefineTriggered()
     }
 }
 
+void FunctionsWidget::onActionDecompileSelectedTriggered()
+{
+    QList<RVA> addrs;
+    QSet<RVA> seen;
+    for (const auto &index : ui->treeView->selectionModel()->selection().indexes()) {
+        RVA addr = functionProxyModel->address(index);
+        if (!seen.contains(addr)) {
+            seen.insert(addr);
+            addrs << addr;
+        }
+    }
+    if (!addrs.isEmpty()) {
+        exportDecompiled(addrs);
+    }
+}
+
+void FunctionsWidget::onActionDecompileAllTriggered()
+{
+    exportDecompiled({});
+}
+
+void FunctionsWidget::exportDecompiled(const QList<RVA> &addrs)
+{
+    if (exportTask) {
+        QMessageBox::warning(
+            this,
+            tr("Decompile to Directory"),
+            tr("Another set of functions is being decompiled."));
+        return;
+    }
+    Decompiler *decompiler = DecompileExportTask::exportDecompiler();
+    if (!decompiler) {
+        QMessageBox::warning(
+            this,
+            tr("Decompile to Directory"),
+            tr("None of the available decompilers can run in a separate radare2 process."));
+        return;
+    }
+    QString dir = QFileDialog::getExistingDirectory(
+        this,
+        tr("Select the directory to write the decompiled functions to"),
+        QString(),
+        QFileDialog::ShowDirsOnly | QFILEDIALOG_FLAGS);
+    if (dir.isEmpty()) {
+        return;
+    }
+
+    exportTask.reset(new DecompileExportTask(decompiler, addrs, dir));
+    auto taskDialog = new AsyncTaskDialog(exportTask, this);
+    taskDialog->setInterruptOnClose(true);
+    taskDialog->setAttribute(Qt::WA_DeleteOnClose);
+    taskDialog->show();
+    connect(exportTask.data(), &AsyncTask::finished, this, [this, dir]() {
+        QMessageBox::information(
+            this,
+            tr("Decompile to Directory"),
+            tr("Wrote %1 of %2 functions to %3.")
+                .arg(exportTask->getWrittenCount())
+                .arg(exportTask->getFunctionCount())
+                .arg(dir));
+        exportTask.clear();
+    });
+    Core()->getAsyncTaskManager()->start(exportTask);
+}
+
 void FunctionsWidget::showTitleContextMenu(const QPoint &pt)
 {
     titleContextMenu->exec(this->mapToGlobal(pt));
@@ -647,6 +732,6 @@ void FunctionsWidget::setTooltipStylesheet()
                           "opacity: 230; background-color: %2;"
                           "color: %3; border-color: %3;}")
                       .arg(kMaxTooltipWidth)
-                      .arg(Config()->getColor("gui.tooltip.background").name())
-                      .arg(Config()->getColor("gui.tooltip.foreground").name()));
+                      .arg(ConfigColor("gui.tooltip.background").name())
+                      .arg(ConfigColor("gui.tooltip.foreground").name()));
 }
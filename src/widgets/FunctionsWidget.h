@@ -9,6 +9,7 @@
 
 class MainWindow;
 class FunctionsTask;
+class DecompileExportTask;
 class FunctionsWidget;
 
 class FunctionModel : public AddressableItemModel<>
@@ -109,6 +110,8 @@ public:
 private slots:
     void onActionFunctionsRenameTriggered();
     void onActionFunctionsUndefineTriggered();
+    void onActionDecompileSelectedTriggered();
+    void onActionDecompileAllTriggered();
     void onActionHorizontalToggled(bool enable);
     void onActionVerticalToggled(bool enable);
     void showTitleContextMenu(const QPoint &pt);
@@ -117,6 +120,7 @@ private slots:
 
 private:
     QSharedPointer<FunctionsTask> task;
+    QSharedPointer<DecompileExportTask> exportTask;
     QList<FunctionDescription> functions;
     QSet<RVA> importAddresses;
     ut64 mainAdress;
@@ -127,8 +131,16 @@ private:
 
     QAction actionRename;
     QAction actionUndefine;
+    QAction actionDecompileSelected;
+    QAction actionDecompileAll;
     QAction actionHorizontal;
     QAction actionVertical;
+
+    /**
+     * @brief Ask for a directory and decompile the functions at addrs into
+     * it, every function if addrs is empty
+     */
+    void exportDecompiled(const QList<RVA> &addrs);
 };
 
 #endif // FUNCTIONSWIDGET_H
@@ -309,6 +309,9 @@ void GraphGridLayout::CalculateLayout(
 
     auto blockOrder = topoSort(layoutState, entry);
     computeAllBlockPlacement(blockOrder, layoutState);
+    if (isInterrupted()) {
+        return;
+    }
 
     for (auto &blockIt : blocks) {
         layoutState.edge[blockIt.first].resize(blockIt.second.edges.size());
@@ -348,9 +351,12 @@ void GraphGridLayout::CalculateLayout(
     }
 
     routeEdges(layoutState);
+    if (isInterrupted()) {
+        return;
+    }
 
     convertToPixelCoordinates(layoutState, width, height);
-    if (useLayoutOptimization) {
+    if (useLayoutOptimization && !isInterrupted()) {
         optimizeLayout(layoutState);
         cropToContent(blocks, width, height);
     }
@@ -1756,6 +1762,9 @@ void GraphGridLayout::optimizeLayout(GraphGridLayout::LayoutState &state) const
     optimizeLinearProgram(solution.size(), objectiveFunction, inequalities, equalities, solution);
     copyVariablesToPositions(solution, true);
     connectEdgeEnds(*state.blocks);
+    if (isInterrupted()) {
+        return;
+    }
 
     // vertical segments
     variableGroups.resize(blockMapping.size());
@@ -20,6 +20,10 @@ public:
 
     GraphGridLayout(LayoutType layoutType = LayoutType::Medium);
     virtual void CalculateLayout(Graph &blocks, ut64 entry, int &width, int &height) const override;
+    std::unique_ptr<GraphLayout> clone() const override
+    {
+        return std::unique_ptr<GraphLayout>(new GraphGridLayout(*this));
+    }
     void setTightSubtreePlacement(bool enabled) { tightSubtreePlacement = enabled; }
     void setParentBetweenDirectChild(bool enabled) { parentBetweenDirectChild = enabled; }
     void setverticalBlockAlignmentMiddle(bool enabled) { verticalBlockAlignmentMiddle = enabled; }
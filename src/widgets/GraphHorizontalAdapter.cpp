@@ -53,6 +53,21 @@ void GraphHorizontalAdapter::setLayoutConfig(const GraphLayout::LayoutConfig &co
     layout->setLayoutConfig(config);
 }
 
+std::unique_ptr<GraphLayout> GraphHorizontalAdapter::clone() const
+{
+    std::unique_ptr<GraphHorizontalAdapter> result(new GraphHorizontalAdapter(layout->clone()));
+    // already in swapped direction
+    result->layoutConfig = layoutConfig;
+    result->setInterruptCheck(interruptCheck);
+    return result;
+}
+
+void GraphHorizontalAdapter::setInterruptCheck(InterruptCheck check)
+{
+    layout->setInterruptCheck(check);
+    GraphLayout::setInterruptCheck(std::move(check));
+}
+
 void GraphHorizontalAdapter::swapLayoutConfigDirection()
 {
     std::swap(layoutConfig.edgeVerticalSpacing, layoutConfig.edgeHorizontalSpacing);
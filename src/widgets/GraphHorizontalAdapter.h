@@ -14,6 +14,9 @@ public:
     virtual void CalculateLayout(
         GraphLayout::Graph &blocks, ut64 entry, int &width, int &height) const override;
     void setLayoutConfig(const LayoutConfig &config) override;
+    std::unique_ptr<GraphLayout> clone() const override;
+    void setInterruptCheck(InterruptCheck check) override;
+    bool isSerialized() const override { return layout->isSerialized(); }
 
 private:
     std::unique_ptr<GraphLayout> layout;
@@ -3,6 +3,8 @@
 
 #include "core/Iaito.h"
 
+#include <functional>
+#include <memory>
 #include <unordered_map>
 
 class GraphLayout
@@ -47,9 +49,29 @@ public:
     virtual ~GraphLayout() {}
     virtual void CalculateLayout(Graph &blocks, ut64 entry, int &width, int &height) const = 0;
     virtual void setLayoutConfig(const LayoutConfig &config) { this->layoutConfig = config; };
+    /**
+     * @brief Create an independent copy of the layout with the same settings,
+     * used for running the layout on another thread.
+     */
+    virtual std::unique_ptr<GraphLayout> clone() const = 0;
+    /**
+     * @brief Whether the layout may wait for a layout of another graph, it
+     * must then never run on the GUI thread, whatever the size of the graph
+     */
+    virtual bool isSerialized() const { return false; }
+
+    using InterruptCheck = std::function<bool()>;
+    /**
+     * @brief Set a check polled by CalculateLayout between its stages, when it
+     * returns true the layout stops early and the result must be discarded.
+     */
+    virtual void setInterruptCheck(InterruptCheck check) { interruptCheck = std::move(check); }
 
 protected:
     LayoutConfig layoutConfig;
+    InterruptCheck interruptCheck;
+
+    bool isInterrupted() const { return interruptCheck && interruptCheck(); }
 };
 
 #endif // GRAPHLAYOUT_H
@@ -6,6 +6,8 @@
 #endif
 #include "GraphHorizontalAdapter.h"
 #include "Helpers.h"
+#include "common/GraphLayoutTask.h"
+#include "dialogs/AsyncTaskDialog.h"
 
 #include <vector>
 #include <QKeyEvent>
@@ -13,6 +15,8 @@
 #include <QPainter>
 #include <QPropertyAnimation>
 #include <QSvgGenerator>
+#include <QTimer>
+#include <QtMath>
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
 #define IAITO_NO_OPENGL_GRAPH 1
@@ -25,13 +29,13 @@
 #include <QOpenGLWidget>
 #endif
 
+// room left around blocks for their border and shadow when checking what to
+// paint
+static const qreal BLOCK_MARGIN = 4;
+
 GraphView::GraphView(QWidget *parent)
     : QAbstractScrollArea(parent)
     , useGL(false)
-#ifndef IAITO_NO_OPENGL_GRAPH
-    , cacheTexture(0)
-    , cacheFBO(0)
-#endif
 {
 #ifndef IAITO_NO_OPENGL_GRAPH
     if (useGL) {
@@ -44,7 +48,19 @@ GraphView::GraphView(QWidget *parent)
     setGraphLayout(makeGraphLayout(Layout::GridMedium));
 }
 
-GraphView::~GraphView() {}
+GraphView::~GraphView()
+{
+    if (layoutTask) {
+        layoutTask->interrupt();
+    }
+#ifndef IAITO_NO_OPENGL_GRAPH
+    if (useGL) {
+        glWidget->makeCurrent();
+        clearTiles();
+        glWidget->doneCurrent();
+    }
+#endif
+}
 
 // Callbacks
 
@@ -84,6 +100,8 @@ void GraphView::blockTransitionedTo(GraphView::GraphBlock *to)
     Q_UNUSED(to);
 }
 
+void GraphView::layoutApplied() {}
+
 GraphView::EdgeConfiguration GraphView::edgeConfiguration(
     GraphView::GraphBlock &from, GraphView::GraphBlock *to, bool interactive)
 {
@@ -131,9 +149,67 @@ void GraphView::contextMenuEvent(QContextMenuEvent *event)
 
 void GraphView::computeGraphPlacement()
 {
-    graphLayoutSystem->CalculateLayout(blocks, entry, width, height);
+    int generation = ++layoutGeneration;
+    if (layoutTask) {
+        layoutTask->interrupt();
+        layoutTask.clear();
+    }
+    if (layoutDialog) {
+        layoutDialog->close();
+    }
+    layoutCanceled = false;
+
+    // A serialized layout may wait for the one of a graph shown before, which
+    // can't be interrupted, so it always goes through the task
+    if (blocks.size() < ASYNC_LAYOUT_MIN_BLOCKS && !graphLayoutSystem->isSerialized()) {
+        graphLayoutSystem->CalculateLayout(blocks, entry, width, height);
+        setCacheDirty();
+        clampViewOffset();
+        viewport()->update();
+        return;
+    }
+
+    layoutTask.reset(new GraphLayoutTask(graphLayoutSystem->clone(), blocks, entry));
+    connect(layoutTask.data(), &AsyncTask::finished, this, [this, generation]() {
+        layoutTaskFinished(generation);
+    });
+    Core()->getAsyncTaskManager()->start(layoutTask);
+
+    // Only bother the user with a dialog if the layout takes a while
+    QTimer::singleShot(LAYOUT_DIALOG_DELAY_MS, this, [this, generation]() {
+        if (generation != layoutGeneration || !layoutTask || layoutDialog) {
+            return;
+        }
+        layoutDialog = new AsyncTaskDialog(layoutTask, this);
+        layoutDialog->setAttribute(Qt::WA_DeleteOnClose);
+        layoutDialog->show();
+    });
+    viewport()->update();
+}
+
+void GraphView::layoutTaskFinished(int generation)
+{
+    if (generation != layoutGeneration || !layoutTask) {
+        return;
+    }
+    QSharedPointer<GraphLayoutTask> task = layoutTask;
+    layoutTask.clear();
+    if (layoutDialog) {
+        layoutDialog->close();
+    }
+    if (task->isInterrupted()) {
+        layoutCanceled = true;
+        viewport()->update();
+        return;
+    }
+
+    // blocks are left untouched while a layout is pending, swap in the result
+    std::swap(blocks, task->getGraph());
+    width = task->getWidth();
+    height = task->getHeight();
     setCacheDirty();
     clampViewOffset();
+    layoutApplied();
     viewport()->update();
 }
 
@@ -176,107 +252,118 @@ void GraphView::setViewScale(qreal scale)
     emit viewScaleChanged(scale);
 }
 
-QSize GraphView::getCacheSize()
-{
-    return
-#ifndef IAITO_NO_OPENGL_GRAPH
-        useGL ? cacheSize :
-#endif
-              pixmap.size();
-}
-
-qreal GraphView::getCacheDevicePixelRatioF()
-{
-    return
-#ifndef IAITO_NO_OPENGL_GRAPH
-        useGL ? 1.0 :
-#endif
-              qhelpers::devicePixelRatio(&pixmap);
-}
-
-QSize GraphView::getRequiredCacheSize()
-{
-    return viewport()->size() * qhelpers::devicePixelRatio(this);
-}
-
-qreal GraphView::getRequiredCacheDevicePixelRatioF()
-{
-    return
-#ifndef IAITO_NO_OPENGL_GRAPH
-        useGL ? 1.0f :
-#endif
-              qhelpers::devicePixelRatio(this);
-}
-
 void GraphView::paintEvent(QPaintEvent *)
 {
+    if (layoutTask || layoutCanceled) {
+        QPainter p(viewport());
+        p.fillRect(viewport()->rect(), backgroundColor);
+        p.setPen(palette().color(QPalette::WindowText));
+        p.drawText(
+            viewport()->rect(),
+            Qt::AlignCenter,
+            layoutCanceled ? tr("Graph layout canceled") : tr("Computing graph layout..."));
+        return;
+    }
+
 #ifndef IAITO_NO_OPENGL_GRAPH
     if (useGL) {
         glWidget->makeCurrent();
     }
 #endif
 
-    if (!qFuzzyCompare(getCacheDevicePixelRatioF(), getRequiredCacheDevicePixelRatioF())
-        || getCacheSize() != getRequiredCacheSize()) {
-        setCacheDirty();
-    }
-
-    if (cacheDirty) {
-        paintGraphCache();
+    const qreal dpr = qhelpers::devicePixelRatio(this);
+    if (cacheDirty || !qFuzzyCompare(tileScale, current_scale)
+        || !qFuzzyCompare(tileDevicePixelRatio, dpr)) {
+        clearTiles();
+        dirtyAreas.clear();
+        tileScale = current_scale;
+        tileDevicePixelRatio = dpr;
         cacheDirty = false;
+    } else {
+        dropDirtyTiles();
+    }
+
+    // Visible area in device pixels at the current scale, the same space tiles
+    // are laid out in
+    const qreal deviceScale = current_scale * dpr;
+    const QPoint origin(qRound(offset.x() * deviceScale), qRound(offset.y() * deviceScale));
+    const QSize deviceSize = viewport()->size() * dpr;
+    const int firstColumn = qFloor(qreal(origin.x()) / TILE_SIZE);
+    const int firstRow = qFloor(qreal(origin.y()) / TILE_SIZE);
+    const int lastColumn = qFloor(qreal(origin.x() + deviceSize.width() - 1) / TILE_SIZE);
+    const int lastRow = qFloor(qreal(origin.y() + deviceSize.height() - 1) / TILE_SIZE);
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            const TileKey key(column, row);
+            auto it = tiles.find(key);
+            if (it == tiles.end()) {
+                it = tiles.insert(key, RenderTile());
+                paintTile(key, it.value());
+            }
+        }
     }
 
     if (useGL) {
 #ifndef IAITO_NO_OPENGL_GRAPH
         auto gl = glWidget->context()->extraFunctions();
-        gl->glBindFramebuffer(GL_READ_FRAMEBUFFER, cacheFBO);
         gl->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, glWidget->defaultFramebufferObject());
-        auto dpr = qhelpers::devicePixelRatio(this);
-        gl->glBlitFramebuffer(
-            0,
-            0,
-            cacheSize.width(),
-            cacheSize.height(),
-            0,
-            0,
-            viewport()->width() * dpr,
-            viewport()->height() * dpr,
-            GL_COLOR_BUFFER_BIT,
-            GL_NEAREST);
-        glWidget->doneCurrent();
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (int column = firstColumn; column <= lastColumn; column++) {
+                const RenderTile &tile = tiles[TileKey(column, row)];
+                const int x = column * TILE_SIZE - origin.x();
+                // GL framebuffers start at the bottom left corner
+                const int y = deviceSize.height() - (row * TILE_SIZE - origin.y()) - TILE_SIZE;
+                gl->glBindFramebuffer(GL_READ_FRAMEBUFFER, tile.fbo);
+                gl->glBlitFramebuffer(
+                    0,
+                    0,
+                    TILE_SIZE,
+                    TILE_SIZE,
+                    x,
+                    y,
+                    x + TILE_SIZE,
+                    y + TILE_SIZE,
+                    GL_COLOR_BUFFER_BIT,
+                    GL_NEAREST);
+            }
+        }
 #endif
     } else {
         QPainter p(viewport());
-        p.drawPixmap(QPoint(0, 0), pixmap);
+        for (int row = firstRow; row <= lastRow; row++) {
+            for (int column = firstColumn; column <= lastColumn; column++) {
+                const RenderTile &tile = tiles[TileKey(column, row)];
+                QPointF pos(column * TILE_SIZE - origin.x(), row * TILE_SIZE - origin.y());
+                p.drawPixmap(pos / dpr, tile.pixmap);
+            }
+        }
     }
-}
 
-void GraphView::clampViewOffset()
-{
-    const qreal edgeFraction = 0.25;
-    qreal edgeX = edgeFraction * (viewport()->width() / current_scale);
-    qreal edgeY = edgeFraction * (viewport()->height() / current_scale);
-    offset.rx() = std::max(
-        std::min(qreal(offset.x()), width - edgeX), -viewport()->width() / current_scale + edgeX);
-    offset.ry() = std::max(
-        std::min(qreal(offset.y()), height - edgeY), -viewport()->height() / current_scale + edgeY);
-}
-
-void GraphView::setViewOffsetInternal(QPoint pos, bool emitSignal)
-{
-    offset = pos;
-    clampViewOffset();
-    if (emitSignal)
-        emit viewOffsetChanged(offset);
-}
+    // Keep a ring of tiles around the viewport for panning back and forth,
+    // release everything else
+    for (auto it = tiles.begin(); it != tiles.end();) {
+        if (it.key().first < firstColumn - TILE_KEEP_MARGIN
+            || it.key().first > lastColumn + TILE_KEEP_MARGIN
+            || it.key().second < firstRow - TILE_KEEP_MARGIN
+            || it.key().second > lastRow + TILE_KEEP_MARGIN) {
+            releaseTile(it.value());
+            it = tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
 
-void GraphView::addViewOffset(QPoint move, bool emitSignal)
-{
-    setViewOffsetInternal(offset + move, emitSignal);
+#ifndef IAITO_NO_OPENGL_GRAPH
+    if (useGL) {
+        glWidget->doneCurrent();
+    }
+#endif
 }
 
-void GraphView::paintGraphCache()
+void GraphView::paintTile(const TileKey &key, RenderTile &tile)
 {
+    const qreal dpr = tileDevicePixelRatio;
 #ifndef IAITO_NO_OPENGL_GRAPH
     std::unique_ptr<QOpenGLPaintDevice> paintDevice;
 #endif
@@ -284,67 +371,154 @@ void GraphView::paintGraphCache()
     if (useGL) {
 #ifndef IAITO_NO_OPENGL_GRAPH
         auto gl = QOpenGLContext::currentContext()->functions();
-
-        bool resizeTex = false;
-        QSize sizeNeed = getRequiredCacheSize();
-        if (!cacheTexture) {
-            gl->glGenTextures(1, &cacheTexture);
-            gl->glBindTexture(GL_TEXTURE_2D, cacheTexture);
+        if (!tile.texture) {
+            gl->glGenTextures(1, &tile.texture);
+            gl->glBindTexture(GL_TEXTURE_2D, tile.texture);
             gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
             gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-            gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
             gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            resizeTex = true;
-        } else if (cacheSize != sizeNeed) {
-            gl->glBindTexture(GL_TEXTURE_2D, cacheTexture);
-            resizeTex = true;
-        }
-        if (resizeTex) {
-            cacheSize = sizeNeed;
             gl->glTexImage2D(
                 GL_TEXTURE_2D,
                 0,
                 GL_RGBA,
-                cacheSize.width(),
-                cacheSize.height(),
+                TILE_SIZE,
+                TILE_SIZE,
                 0,
                 GL_RGBA,
                 GL_UNSIGNED_BYTE,
                 nullptr);
-            gl->glGenFramebuffers(1, &cacheFBO);
-            gl->glBindFramebuffer(GL_FRAMEBUFFER, cacheFBO);
+            gl->glGenFramebuffers(1, &tile.fbo);
+            gl->glBindFramebuffer(GL_FRAMEBUFFER, tile.fbo);
             gl->glFramebufferTexture2D(
-                GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, cacheTexture, 0);
+                GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tile.texture, 0);
         } else {
-            gl->glBindFramebuffer(GL_FRAMEBUFFER, cacheFBO);
+            gl->glBindFramebuffer(GL_FRAMEBUFFER, tile.fbo);
         }
-        gl->glViewport(0, 0, viewport()->width(), viewport()->height());
+        gl->glViewport(0, 0, TILE_SIZE, TILE_SIZE);
         gl->glClearColor(
             backgroundColor.redF(), backgroundColor.greenF(), backgroundColor.blueF(), 1.0f);
         gl->glClear(GL_COLOR_BUFFER_BIT);
 
-        paintDevice.reset(new QOpenGLPaintDevice(cacheSize));
+        paintDevice.reset(new QOpenGLPaintDevice(TILE_SIZE, TILE_SIZE));
+        paintDevice->setDevicePixelRatio(dpr);
         p.begin(paintDevice.get());
 #endif
     } else {
-        auto dpr = qhelpers::devicePixelRatio(this);
-        pixmap = QPixmap(getRequiredCacheSize() * dpr);
-        pixmap.setDevicePixelRatio(dpr);
-        pixmap.fill(backgroundColor);
-        p.begin(&pixmap);
+        tile.pixmap = QPixmap(TILE_SIZE, TILE_SIZE);
+        tile.pixmap.setDevicePixelRatio(dpr);
+        tile.pixmap.fill(backgroundColor);
+        p.begin(&tile.pixmap);
         p.setRenderHint(QPainter::Antialiasing);
-        p.setViewport(this->viewport()->rect());
     }
-    paint(p, offset, this->viewport()->rect(), current_scale);
+
+    // Tile position and size in logical coordinates
+    const qreal logicalSize = TILE_SIZE / (tileScale * dpr);
+    const QRectF area(key.first * logicalSize, key.second * logicalSize, logicalSize, logicalSize);
+    p.scale(tileScale, tileScale);
+    p.translate(-area.topLeft());
+    paintArea(p, area, tileScale, true);
 
     p.end();
 }
 
+void GraphView::releaseTile(RenderTile &tile)
+{
+#ifndef IAITO_NO_OPENGL_GRAPH
+    if (tile.texture) {
+        auto gl = QOpenGLContext::currentContext()->functions();
+        gl->glDeleteFramebuffers(1, &tile.fbo);
+        gl->glDeleteTextures(1, &tile.texture);
+        tile.fbo = 0;
+        tile.texture = 0;
+    }
+#endif
+    tile.pixmap = QPixmap();
+}
+
+void GraphView::clearTiles()
+{
+    for (RenderTile &tile : tiles) {
+        releaseTile(tile);
+    }
+    tiles.clear();
+}
+
+void GraphView::dropDirtyTiles()
+{
+    const qreal logicalSize = TILE_SIZE / (tileScale * tileDevicePixelRatio);
+    for (const QRectF &area : dirtyAreas) {
+        const int firstColumn = qFloor(area.left() / logicalSize);
+        const int lastColumn = qFloor(area.right() / logicalSize);
+        const int firstRow = qFloor(area.top() / logicalSize);
+        const int lastRow = qFloor(area.bottom() / logicalSize);
+        for (auto it = tiles.begin(); it != tiles.end();) {
+            if (it.key().first >= firstColumn && it.key().first <= lastColumn
+                && it.key().second >= firstRow && it.key().second <= lastRow) {
+                releaseTile(it.value());
+                it = tiles.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    dirtyAreas.clear();
+}
+
+void GraphView::setAreaDirty(const QRectF &area)
+{
+    if (!cacheDirty) {
+        dirtyAreas.append(area);
+    }
+}
+
+void GraphView::setBlockDirty(ut64 entry)
+{
+    auto blockIt = blocks.find(entry);
+    if (blockIt == blocks.end()) {
+        return;
+    }
+    const GraphBlock &block = blockIt->second;
+    setAreaDirty(QRectF(block.x, block.y, block.width, block.height)
+                     .adjusted(-BLOCK_MARGIN, -BLOCK_MARGIN, BLOCK_MARGIN, BLOCK_MARGIN));
+
+    const qreal margin = edgeMargin(current_scale);
+    for (auto &it : blocks) {
+        for (const GraphEdge &edge : it.second.edges) {
+            if ((it.first == entry || edge.target == entry) && !edge.polyline.empty()) {
+                setAreaDirty(edge.polyline.boundingRect().adjusted(-margin, -margin, margin, margin));
+            }
+        }
+    }
+}
+
+void GraphView::clampViewOffset()
+{
+    const qreal edgeFraction = 0.25;
+    qreal edgeX = edgeFraction * (viewport()->width() / current_scale);
+    qreal edgeY = edgeFraction * (viewport()->height() / current_scale);
+    offset.rx() = std::max(
+        std::min(qreal(offset.x()), width - edgeX), -viewport()->width() / current_scale + edgeX);
+    offset.ry() = std::max(
+        std::min(qreal(offset.y()), height - edgeY), -viewport()->height() / current_scale + edgeY);
+}
+
+void GraphView::setViewOffsetInternal(QPoint pos, bool emitSignal)
+{
+    offset = pos;
+    clampViewOffset();
+    if (emitSignal)
+        emit viewOffsetChanged(offset);
+}
+
+void GraphView::addViewOffset(QPoint move, bool emitSignal)
+{
+    setViewOffsetInternal(offset + move, emitSignal);
+}
+
 void GraphView::paint(QPainter &p, QPoint offset, QRect viewport, qreal scale, bool interactive)
 {
     QPointF offsetF(offset.x(), offset.y());
-    p.setBrush(Qt::black);
 
     int render_width = viewport.width();
     int render_height = viewport.height();
@@ -354,6 +528,20 @@ void GraphView::paint(QPainter &p, QPoint offset, QRect viewport, qreal scale, b
     p.setWindow(window);
     QRectF windowF(window.x(), window.y(), window.width(), window.height());
 
+    paintArea(p, windowF, scale, interactive);
+}
+
+qreal GraphView::edgeMargin(qreal scale) const
+{
+    // arrow heads and pens wider than a pixel when zoomed out
+    return 10 + 4 / scale;
+}
+
+void GraphView::paintArea(QPainter &p, const QRectF &area, qreal scale, bool interactive)
+{
+    p.setBrush(Qt::black);
+
+    const qreal margin = edgeMargin(scale);
     for (auto &blockIt : blocks) {
         GraphBlock &block = blockIt.second;
 
@@ -361,19 +549,23 @@ void GraphView::paint(QPainter &p, QPoint offset, QRect viewport, qreal scale, b
 
         // Check if block is visible by checking if block intersects with view
         // area
-        if (blockRect.intersects(windowF)) {
+        if (blockRect.adjusted(-BLOCK_MARGIN, -BLOCK_MARGIN, BLOCK_MARGIN, BLOCK_MARGIN)
+                .intersects(area)) {
             drawBlock(p, block, interactive);
         }
 
         p.setBrush(Qt::gray);
 
-        // Always draw edges
-        // TODO: Only draw edges if they are actually visible ...
         // Draw edges
         for (GraphEdge &edge : block.edges) {
             if (edge.polyline.empty()) {
                 continue;
             }
+            if (!edge.polyline.boundingRect()
+                     .adjusted(-margin, -margin, margin, margin)
+                     .intersects(area)) {
+                continue;
+            }
             QPolygonF polyline = edge.polyline;
             EdgeConfiguration ec = edgeConfiguration(block, &blocks[edge.target], interactive);
             QPen pen(ec.color);
@@ -527,6 +719,10 @@ void GraphView::showRectangle(const QRect &block, bool anywhere)
 
 GraphView::GraphBlock *GraphView::getBlockContaining(QPoint p)
 {
+    if (layoutTask || layoutCanceled) {
+        // positions are not known yet
+        return nullptr;
+    }
     // Check if a block was clicked
     for (auto &blockIt : blocks) {
         GraphBlock &block = blockIt.second;
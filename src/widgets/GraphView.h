@@ -4,10 +4,14 @@
 #include <QAbstractScrollArea>
 #include <QElapsedTimer>
 #include <QGestureEvent>
+#include <QHash>
 #include <QHelpEvent>
 #include <QObject>
 #include <QPainter>
+#include <QPixmap>
+#include <QPointer>
 #include <QScrollBar>
+#include <QSharedPointer>
 #include <QWidget>
 
 #include <memory>
@@ -26,6 +30,8 @@
 #ifndef IAITO_NO_OPENGL_GRAPH
 class QOpenGLWidget;
 #endif
+class GraphLayoutTask;
+class AsyncTaskDialog;
 
 class GraphView : public QAbstractScrollArea
 {
@@ -101,7 +107,13 @@ public:
         QString path, const char *format = nullptr, double scaler = 1.0, bool transparent = false);
     void saveAsSvg(QString path);
 
+    /**
+     * @brief Compute the position of blocks and edges. Big graphs are laid out
+     * in the background on a copy of the graph, a placeholder is shown and
+     * blocks keep their old positions until layoutApplied() is called.
+     */
     void computeGraphPlacement();
+    bool isLayoutPending() const { return !layoutTask.isNull(); }
 
     /**
      * @brief Remove duplicate edges and edges without target in graph.
@@ -117,7 +129,23 @@ protected:
     // Padding inside the block
     int block_padding = 16;
 
+    /**
+     * @brief Drop the whole render cache, everything is painted again on the
+     * next draw.
+     */
     void setCacheDirty() { cacheDirty = true; }
+    /**
+     * @brief Paint again only the area covered by a block and the edges going
+     * in and out of it, use it when only the look of that block changed (for
+     * example its selection).
+     * @param entry - entry of the block
+     */
+    void setBlockDirty(ut64 entry);
+    /**
+     * @brief Paint again only the given area
+     * @param area - rectangle in graph logical coordinates
+     */
+    void setAreaDirty(const QRectF &area);
 
     void addBlock(GraphView::GraphBlock block);
     void setEntry(ut64 e);
@@ -135,6 +163,11 @@ protected:
     virtual void blockHelpEvent(GraphView::GraphBlock &block, QHelpEvent *event, QPoint pos);
     virtual bool helpEvent(QHelpEvent *event);
     virtual void blockTransitionedTo(GraphView::GraphBlock *to);
+    /**
+     * @brief Called after a layout computed in the background by
+     * computeGraphPlacement() has replaced the block positions.
+     */
+    virtual void layoutApplied();
     virtual void wheelEvent(QWheelEvent *event) override;
     virtual EdgeConfiguration edgeConfiguration(
         GraphView::GraphBlock &from, GraphView::GraphBlock *to, bool interactive = true);
@@ -176,7 +209,12 @@ private:
     void centerX(bool emitSignal);
     void centerY(bool emitSignal);
 
-    void paintGraphCache();
+    /**
+     * @brief Paint the blocks and edges intersecting area. Painter transform
+     * must already map logical coordinates.
+     */
+    void paintArea(QPainter &p, const QRectF &area, qreal scale, bool interactive);
+    qreal edgeMargin(qreal scale) const;
 
     bool checkPointClicked(QPointF &point, int x, int y, bool above_y = false);
 
@@ -196,27 +234,55 @@ private:
 
     bool useGL;
 
-    /**
-     * @brief pixmap that caches the graph nodes
-     */
-    QPixmap pixmap;
+    // graphs with at least this many blocks are laid out in the background
+    static constexpr size_t ASYNC_LAYOUT_MIN_BLOCKS = 100;
+    // delay before showing a progress dialog for a background layout
+    static constexpr int LAYOUT_DIALOG_DELAY_MS = 500;
+    QSharedPointer<GraphLayoutTask> layoutTask;
+    QPointer<AsyncTaskDialog> layoutDialog;
+    // incremented for every layout, results of superseded ones are dropped
+    int layoutGeneration = 0;
+    bool layoutCanceled = false;
+    void layoutTaskFinished(int generation);
 
 #ifndef IAITO_NO_OPENGL_GRAPH
-    uint32_t cacheTexture;
-    uint32_t cacheFBO;
-    QSize cacheSize;
     QOpenGLWidget *glWidget;
 #endif
 
+    /**
+     * @brief Square piece of the rendered graph. Tiles are laid on a grid in
+     * device pixels at the scale they were painted with, so they stay valid
+     * while the view is panned and only newly exposed ones get painted.
+     */
+    struct RenderTile
+    {
+        QPixmap pixmap;
+#ifndef IAITO_NO_OPENGL_GRAPH
+        uint32_t texture = 0;
+        uint32_t fbo = 0;
+#endif
+    };
+    using TileKey = QPair<int, int>;
+    // size of a tile side in device pixels
+    static constexpr int TILE_SIZE = 256;
+    // tiles further than this from the viewport are released
+    static constexpr int TILE_KEEP_MARGIN = 2;
+
+    QHash<TileKey, RenderTile> tiles;
+    qreal tileScale = 0;
+    qreal tileDevicePixelRatio = 0;
+    QVector<QRectF> dirtyAreas;
+
     /**
      * @brief flag to control if the cache is invalid and should be re-created
      * in the next draw
      */
     bool cacheDirty = true;
-    QSize getCacheSize();
-    qreal getCacheDevicePixelRatioF();
-    QSize getRequiredCacheSize();
-    qreal getRequiredCacheDevicePixelRatioF();
+
+    void paintTile(const TileKey &key, RenderTile &tile);
+    void releaseTile(RenderTile &tile);
+    void clearTiles();
+    void dropDirtyTiles();
 
     void beginMouseDrag(QMouseEvent *event);
 
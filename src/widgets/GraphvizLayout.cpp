@@ -9,8 +9,16 @@
 #include <unordered_set>
 #include <queue>
 
+#include <QMutex>
+
 #include <gvc.h>
 
+// gvc and cgraph keep global state and are not thread safe, while
+// GraphLayoutTasks may outlive the graph they were started for. Every
+// graphviz call is made holding this, so GraphView never runs these layouts
+// on the GUI thread, see isSerialized().
+static QMutex graphvizMutex;
+
 GraphvizLayout::GraphvizLayout(LayoutType lineType, Direction direction)
     : GraphLayout({})
     , direction(direction)
@@ -90,6 +98,14 @@ void GraphvizLayout::CalculateLayout(
 #define STR(v) const_cast<char *>(v)
 
     width = height = 10;
+    if (isInterrupted()) {
+        return;
+    }
+    QMutexLocker locker(&graphvizMutex);
+    if (isInterrupted()) {
+        // superseded while waiting for another layout
+        return;
+    }
     GVC_t *gvc = gvContext();
     Agraph_t *g = agopen(STR("G"), Agdirected, nullptr);
 
@@ -22,6 +22,12 @@ public:
         ut64 entry,
         int &width,
         int &height) const override;
+    std::unique_ptr<GraphLayout> clone() const override
+    {
+        return std::unique_ptr<GraphLayout>(new GraphvizLayout(*this));
+    }
+    // graphviz calls are serialized, see GraphvizLayout.cpp
+    bool isSerialized() const override { return true; }
 
 private:
     Direction direction;
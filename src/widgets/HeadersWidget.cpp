@@ -1,4 +1,5 @@
 #include "HeadersWidget.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_ListDockWidget.h"
@@ -35,7 +36,7 @@ QVariant HeadersModel::data(const QModelIndex &index, int role) const
         case ValueColumn:
             return header.value;
         case CommentColumn:
-            return Core()->getCommentAt(header.vaddr);
+            return Core()->getCommentCache()->at(header.vaddr);
         default:
             return QVariant();
         }
@@ -106,7 +107,8 @@ bool HeadersProxyModel::lessThan(const QModelIndex &left, const QModelIndex &rig
     case HeadersModel::ValueColumn:
         return leftHeader.value < rightHeader.value;
     case HeadersModel::CommentColumn:
-        return Core()->getCommentAt(leftHeader.vaddr) < Core()->getCommentAt(rightHeader.vaddr);
+        return Core()->getCommentCache()->at(leftHeader.vaddr)
+               < Core()->getCommentCache()->at(rightHeader.vaddr);
     default:
         break;
     }
@@ -390,6 +390,12 @@ void HexWidget::refresh()
     viewport()->update();
 }
 
+void HexWidget::refreshAfterWrite(uint64_t size)
+{
+    Core()->getMemoryPageCache()->invalidate(getLocationAddress(), size);
+    refresh();
+}
+
 void HexWidget::setItemEndianess(bool bigEndian)
 {
     itemBigEndian = bigEndian;
@@ -401,15 +407,15 @@ void HexWidget::setItemEndianess(bool bigEndian)
 
 void HexWidget::updateColors()
 {
-    borderColor = Config()->getColor("gui.border");
-    backgroundColor = Config()->getColor("gui.background");
-    b0x00Color = Config()->getColor("b0x00");
-    b0x7fColor = Config()->getColor("b0x7f");
-    b0xffColor = Config()->getColor("b0xff");
-    printableColor = Config()->getColor("ai.write");
-    defColor = Config()->getColor("btext");
-    addrColor = Config()->getColor("func_var_addr");
-    diffColor = Config()->getColor("graph.diff.unmatch");
+    borderColor = ConfigColor("gui.border");
+    backgroundColor = ConfigColor("gui.background");
+    b0x00Color = ConfigColor("b0x00");
+    b0x7fColor = ConfigColor("b0x7f");
+    b0xffColor = ConfigColor("b0xff");
+    printableColor = ConfigColor("ai.write");
+    defColor = ConfigColor("btext");
+    addrColor = ConfigColor("func_var_addr");
+    diffColor = ConfigColor("graph.diff.unmatch");
 
     updateCursorMeta();
     viewport()->update();
@@ -714,7 +720,7 @@ void HexWidget::w_writeString()
     QString str = d.getText(this, tr("Write string"), tr("String:"), QLineEdit::Normal, "", &ok);
     if (ok && !str.isEmpty()) {
         Core()->cmdRawAt(QStringLiteral("w %1").arg(str), getLocationAddress());
-        refresh();
+        refreshAfterWrite(str.toUtf8().size());
     }
 }
 
@@ -735,7 +741,7 @@ void HexWidget::w_increaseDecrease()
             .arg(mode)
             .arg(QString::number(d.getValue())),
         getLocationAddress());
-    refresh();
+    refreshAfterWrite(d.getNBytes());
 }
 
 void HexWidget::w_writeZeros()
@@ -755,7 +761,7 @@ void HexWidget::w_writeZeros()
         d.getInt(this, tr("Write zeros"), tr("Number of zeros:"), size, 1, 0x7FFFFFFF, 1, &ok));
     if (ok && !str.isEmpty()) {
         Core()->cmdRawAt(QStringLiteral("w0 %1").arg(str), getLocationAddress());
-        refresh();
+        refreshAfterWrite(str.toULongLong());
     }
 }
 
@@ -787,7 +793,8 @@ void HexWidget::w_write64()
     Core()->cmdRawAt(
         QStringLiteral("w6%1 %2").arg(mode).arg((mode == "e" ? str.toHex() : str).toStdString().c_str()),
         getLocationAddress());
-    refresh();
+    // upper bound of what either direction may write
+    refreshAfterWrite((str.size() + 2) / 3 * 4);
 }
 
 void HexWidget::w_writeRandom()
@@ -806,7 +813,7 @@ void HexWidget::w_writeRandom()
         d.getInt(this, tr("Write random"), tr("Number of bytes:"), size, 1, 0x7FFFFFFF, 1, &ok));
     if (ok && !nbytes.isEmpty()) {
         Core()->cmdRawAt(QStringLiteral("wr %1").arg(nbytes), getLocationAddress());
-        refresh();
+        refreshAfterWrite(nbytes.toULongLong());
     }
 }
 
@@ -823,7 +830,7 @@ void HexWidget::w_duplFromOffset()
     RVA copyFrom = d.getOffset();
     QString nBytes = QString::number(d.getNBytes());
     Core()->cmdRawAt(QStringLiteral("wd %1 %2").arg(copyFrom).arg(nBytes), getLocationAddress());
-    refresh();
+    refreshAfterWrite(d.getNBytes());
 }
 
 void HexWidget::w_writePascalString()
@@ -838,7 +845,7 @@ void HexWidget::w_writePascalString()
         = d.getText(this, tr("Write Pascal string"), tr("String:"), QLineEdit::Normal, "", &ok);
     if (ok && !str.isEmpty()) {
         Core()->cmdRawAt(QStringLiteral("ws %1").arg(str), getLocationAddress());
-        refresh();
+        refreshAfterWrite(str.toUtf8().size() + 1);
     }
 }
 
@@ -854,7 +861,7 @@ void HexWidget::w_writeWideString()
         = d.getText(this, tr("Write wide string"), tr("String:"), QLineEdit::Normal, "", &ok);
     if (ok && !str.isEmpty()) {
         Core()->cmdRawAt(QStringLiteral("ww %1").arg(str), getLocationAddress());
-        refresh();
+        refreshAfterWrite(2 * str.toUtf8().size() + 2);
     }
 }
 
@@ -870,7 +877,7 @@ void HexWidget::w_writeCString()
         this, tr("Write zero-terminated string"), tr("String:"), QLineEdit::Normal, "", &ok);
     if (ok && !str.isEmpty()) {
         Core()->cmdRawAt(QStringLiteral("wz %1").arg(str), getLocationAddress());
-        refresh();
+        refreshAfterWrite(str.toUtf8().size() + 1);
     }
 }
 
@@ -3,6 +3,7 @@
 
 #include "Iaito.h"
 #include "common/IOModesController.h"
+#include "common/MemoryPageCache.h"
 #include "dialogs/HexdumpRangeDialog.h"
 
 #include <memory>
@@ -126,11 +127,10 @@ class MemoryData : public AbstractData
 public:
     MemoryData() {}
     ~MemoryData() override {}
-    static constexpr size_t BLOCK_SIZE = 4096;
+    static constexpr size_t BLOCK_SIZE = MemoryPageCache::PAGE_SIZE;
 
     void fetch(uint64_t address, int length) override
     {
-        // FIXME: reuse data if possible
         const uint64_t blockSize = 0x1000ULL;
         uint64_t alignedAddr = address & ~(blockSize - 1);
         int offset = address - alignedAddr;
@@ -141,10 +141,17 @@ public:
             m_lastValidAddr = -1;
             len = m_lastValidAddr - m_firstBlockAddr + 1;
         }
+        // Pages are shared with the cache, so this doesn't copy anything
+        auto cache = Core()->getMemoryPageCache();
         m_blocks.clear();
         uint64_t addr = alignedAddr;
         for (ut64 i = 0; i < len / blockSize; ++i, addr += blockSize) {
-            m_blocks.append(Core()->ioRead(addr, blockSize));
+            m_blocks.append(cache->page(addr));
+        }
+        // Read one screen above and below ahead of scrolling
+        if (len) {
+            uint64_t prefetchAddr = alignedAddr > uint64_t(len) ? alignedAddr - len : 0;
+            cache->prefetch(prefetchAddr, uint64_t(len) * 3, address);
         }
     }
 
@@ -361,6 +368,10 @@ private:
     RVA getLocationAddress();
 
     void fetchData();
+    /**
+     * @brief Drop the cached pages covering a write at the location address and refetch.
+     */
+    void refreshAfterWrite(uint64_t size);
     /**
      * @brief Convert mouse position to address.
      * @param point mouse position in widget
@@ -82,6 +82,15 @@ HexdumpWidget::HexdumpWidget(MainWindow *main)
     connect(Core(), &IaitoCore::instructionChanged, this, [this]() { refresh(); });
     connect(Core(), &IaitoCore::stackChanged, this, [this]() { refresh(); });
     connect(Core(), &IaitoCore::registersChanged, this, [this]() { refresh(); });
+    connect(Core(), &IaitoCore::ioCacheChanged, this, [this]() { refresh(); });
+
+    digestTimer.setInterval(0);
+    connect(&digestTimer, &QTimer::timeout, this, [this]() {
+        if (!digestTask->step()) {
+            digestTimer.stop();
+            showDigests();
+        }
+    });
 
     connect(seekable, &IaitoSeekable::seekableSeekChanged, this, &HexdumpWidget::onSeekChanged);
     connect(ui->hexTextView, &HexWidget::positionChanged, this, [this](RVA addr) {
@@ -111,7 +120,10 @@ void HexdumpWidget::onSeekChanged(RVA addr)
     refresh(addr);
 }
 
-HexdumpWidget::~HexdumpWidget() {}
+HexdumpWidget::~HexdumpWidget()
+{
+    cancelDigests();
+}
 
 QString HexdumpWidget::getWidgetType()
 {
@@ -197,6 +209,7 @@ void HexdumpWidget::fontsUpdated()
 
 void HexdumpWidget::clearParseWindow()
 {
+    cancelDigests();
     ui->hexDisasTextEdit->setPlainText("");
     ui->bytesEntropy->setText("");
     ui->bytesMD5->setText("");
@@ -244,23 +257,57 @@ void HexdumpWidget::updateParseWindow(RVA start_address, int size)
                 : "");
     } else {
         // Fill the information tab hashes and entropy
-        ui->bytesMD5->setText(
-            Core()->cmdRawAt(QStringLiteral("ph md5 %1").arg(size), start_address).trimmed());
-        ui->bytesSHA1->setText(
-            Core()->cmdRawAt(QStringLiteral("ph sha1 %1").arg(size), start_address).trimmed());
-        ui->bytesSHA256->setText(
-            Core()->cmdRawAt(QStringLiteral("ph sha256 %1").arg(size), start_address).trimmed());
-        ui->bytesCRC32->setText(
-            Core()->cmdRawAt(QStringLiteral("ph crc32 %1").arg(size), start_address).trimmed());
-        ui->bytesEntropy->setText(
-            Core()->cmdRawAt(QStringLiteral("ph entropy %1").arg(size), start_address).trimmed());
-        ui->bytesMD5->setCursorPosition(0);
-        ui->bytesSHA1->setCursorPosition(0);
-        ui->bytesSHA256->setCursorPosition(0);
-        ui->bytesCRC32->setCursorPosition(0);
+        startDigests(start_address, size);
     }
 }
 
+void HexdumpWidget::startDigests(RVA addr, ut64 size)
+{
+    cancelDigests();
+    ui->bytesEntropy->setText("");
+    ui->bytesMD5->setText("");
+    ui->bytesSHA1->setText("");
+    ui->bytesSHA256->setText("");
+    ui->bytesCRC32->setText("");
+
+    digestTask.reset(new DigestTask(addr, size));
+#if MONOTHREAD
+    digestTimer.start();
+#else
+    DigestTask *task = digestTask.data();
+    connect(task, &AsyncTask::finished, this, [this, task]() {
+        // a newer selection may have replaced it already
+        if (task == digestTask.data() && !task->isInterrupted()) {
+            showDigests();
+        }
+    });
+    Core()->getAsyncTaskManager()->start(digestTask);
+#endif
+}
+
+void HexdumpWidget::cancelDigests()
+{
+    digestTimer.stop();
+    if (digestTask) {
+        digestTask->interrupt();
+        digestTask.clear();
+    }
+}
+
+void HexdumpWidget::showDigests()
+{
+    DigestTask::Result result = digestTask->getResult();
+    ui->bytesMD5->setText(result.md5);
+    ui->bytesSHA1->setText(result.sha1);
+    ui->bytesSHA256->setText(result.sha256);
+    ui->bytesCRC32->setText(result.crc32);
+    ui->bytesEntropy->setText(result.entropy);
+    ui->bytesMD5->setCursorPosition(0);
+    ui->bytesSHA1->setCursorPosition(0);
+    ui->bytesSHA256->setCursorPosition(0);
+    ui->bytesCRC32->setCursorPosition(0);
+}
+
 void HexdumpWidget::on_parseTypeComboBox_currentTextChanged(const QString &)
 {
     QString currentParseTypeText = ui->parseTypeComboBox->currentData().toString();
@@ -5,12 +5,14 @@
 #include <QDebug>
 #include <QMouseEvent>
 #include <QTextEdit>
+#include <QTimer>
 
 #include <array>
 #include <memory>
 
 #include "HexWidget.h"
 #include "MemoryDockWidget.h"
+#include "common/DigestTask.h"
 #include "common/Highlighter.h"
 #include "common/IaitoSeekable.h"
 #include "common/SvgIconEngine.h"
@@ -50,6 +52,10 @@ private:
     RefreshDeferrer *refreshDeferrer;
     QSyntaxHighlighter *syntaxHighLighter;
 
+    QSharedPointer<DigestTask> digestTask;
+    // steps digestTask on the GUI thread when the core is single threaded
+    QTimer digestTimer;
+
     void refresh();
     void refresh(RVA addr);
     void selectHexPreview();
@@ -59,6 +65,9 @@ private:
     void refreshSelectionInfo();
     void updateParseWindow(RVA start_address, int size);
     void clearParseWindow();
+    void startDigests(RVA addr, ut64 size);
+    void cancelDigests();
+    void showDigests();
     void showSidePanel(bool show);
 
     QString getWindowTitle() const override;
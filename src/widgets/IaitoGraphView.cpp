@@ -242,6 +242,7 @@ void IaitoGraphView::refreshView()
 {
     initFont();
     setLayoutConfig(getLayoutConfig());
+    setCacheDirty();
 }
 
 bool IaitoGraphView::gestureEvent(QGestureEvent *event)
@@ -304,6 +305,13 @@ void IaitoGraphView::saveCurrentBlock() {}
 
 void IaitoGraphView::restoreCurrentBlock() {}
 
+void IaitoGraphView::layoutApplied()
+{
+    center();
+    restoreCurrentBlock();
+    emit viewRefreshed();
+}
+
 void IaitoGraphView::mousePressEvent(QMouseEvent *event)
 {
     GraphView::mousePressEvent(event);
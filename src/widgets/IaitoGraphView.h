@@ -124,6 +124,11 @@ protected:
      * content and the matching node doesn't exist.
      */
     virtual void restoreCurrentBlock();
+    /**
+     * @brief Center the view and restore the current block once a background
+     * layout is done.
+     */
+    void layoutApplied() override;
 
     void initFont();
     QPoint getTextOffset(int line) const;
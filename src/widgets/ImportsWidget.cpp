@@ -1,5 +1,6 @@
 #include "ImportsWidget.h"
 #include "WidgetShortcuts.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_ListDockWidget.h"
@@ -34,14 +35,14 @@ QVariant ImportsModel::data(const QModelIndex &index, int role) const
         if (index.column() < ImportsModel::ColumnCount) {
             // Blue color for unsafe functions
             if (thread_banned.match(imp.name).hasMatch())
-                return Config()->getColor("gui.item_thread_unsafe");
+                return ConfigColor("gui.item_thread_unsafe");
             // Red color for unsafe functions
             if (unsafe_banned.match(imp.name).hasMatch())
-                return Config()->getColor("gui.item_unsafe");
+                return ConfigColor("gui.item_unsafe");
             // Grey color for symbols at offset 0 which can only be filled at
             // runtime
             if (imp.plt == 0)
-                return Config()->getColor("gui.item_invalid");
+                return ConfigColor("gui.item_invalid");
         }
         break;
     case Qt::DisplayRole:
@@ -60,7 +61,7 @@ QVariant ImportsModel::data(const QModelIndex &index, int role) const
         case ImportsModel::NameColumn:
             return imp.name;
         case ImportsModel::CommentColumn:
-            return Core()->getCommentAt(imp.plt);
+            return Core()->getCommentCache()->at(imp.plt);
         default:
             break;
         }
@@ -171,7 +172,8 @@ bool ImportsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &rig
     case ImportsModel::NameColumn:
         return leftImport.name < rightImport.name;
     case ImportsModel::CommentColumn:
-        return Core()->getCommentAt(leftImport.plt) < Core()->getCommentAt(rightImport.plt);
+        return Core()->getCommentCache()->at(leftImport.plt)
+               < Core()->getCommentCache()->at(rightImport.plt);
 
     default:
         break;
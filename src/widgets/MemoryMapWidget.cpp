@@ -1,4 +1,6 @@
 #include "MemoryMapWidget.h"
+#include "common/CommentCache.h"
+#include "common/DebugSnapshot.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_ListDockWidget.h"
@@ -38,7 +40,7 @@ QVariant MemoryMapModel::data(const QModelIndex &index, int role) const
         case PermColumn:
             return memoryMap.permission;
         case CommentColumn:
-            return Core()->getCommentAt(memoryMap.addrStart);
+            return Core()->getCommentCache()->at(memoryMap.addrStart);
         default:
             return QVariant();
         }
@@ -107,8 +109,8 @@ bool MemoryProxyModel::lessThan(const QModelIndex &left, const QModelIndex &righ
     case MemoryMapModel::PermColumn:
         return leftMemMap.permission < rightMemMap.permission;
     case MemoryMapModel::CommentColumn:
-        return Core()->getCommentAt(leftMemMap.addrStart)
-               < Core()->getCommentAt(rightMemMap.addrStart);
+        return Core()->getCommentCache()->at(leftMemMap.addrStart)
+               < Core()->getCommentCache()->at(rightMemMap.addrStart);
     default:
         break;
     }
@@ -149,8 +151,14 @@ void MemoryMapWidget::refreshMemoryMap()
     if (Core()->currentlyEmulating) {
         return;
     }
+    quint64 changed;
+    QList<MemoryMapDescription> maps = Core()->getDebugSnapshot()->getMemoryMap(&changed);
+    if (changed == shownMaps) {
+        return;
+    }
+    shownMaps = changed;
     memoryModel->beginResetModel();
-    memoryMaps = Core()->getMemoryMap();
+    memoryMaps = maps;
     memoryModel->endResetModel();
 
     ui->treeView->resizeColumnToContents(0);
@@ -82,4 +82,6 @@ private:
     QList<MemoryMapDescription> memoryMaps;
 
     RefreshDeferrer *refreshDeferrer;
+    // DebugSnapshot generation of the maps shown
+    quint64 shownMaps = 0;
 };
@@ -1,4 +1,6 @@
 #include "RegisterRefsWidget.h"
+#include "common/CommentCache.h"
+#include "common/DebugSnapshot.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_RegisterRefsWidget.h"
@@ -40,7 +42,7 @@ QVariant RegisterRefModel::data(const QModelIndex &index, int role) const
         case RefColumn:
             return registerRef.refDesc.ref;
         case CommentColumn:
-            return Core()->getCommentAt(Core()->math(registerRef.value));
+            return Core()->getCommentCache()->at(Core()->math(registerRef.value));
         default:
             return QVariant();
         }
@@ -112,8 +114,8 @@ bool RegisterRefProxyModel::lessThan(const QModelIndex &left, const QModelIndex
     case RegisterRefModel::ValueColumn:
         return leftRegRef.value < rightRegRef.value;
     case RegisterRefModel::CommentColumn:
-        return Core()->getCommentAt(Core()->math(leftRegRef.value))
-               < Core()->getCommentAt(Core()->math(rightRegRef.value));
+        return Core()->getCommentCache()->at(Core()->math(leftRegRef.value))
+               < Core()->getCommentCache()->at(Core()->math(rightRegRef.value));
     default:
         break;
     }
@@ -198,21 +200,44 @@ void RegisterRefsWidget::refreshRegisterRef()
         return;
     }
 
-    registerRefModel->beginResetModel();
+    quint64 changed;
+    QList<QJsonObject> regRefs = Core()->getDebugSnapshot()->getRegisterRefs(&changed);
+    if (changed == shownGeneration) {
+        return;
+    }
+    shownGeneration = changed;
 
-    QList<QJsonObject> regRefs = Core()->getRegisterRefs();
-    registerRefs.clear();
-    for (const QJsonObject &reg : regRefs) {
+    auto describe = [](const QJsonObject &reg) {
         RegisterRefDescription desc;
-
         desc.value = RAddressString(reg["value"].toVariant().toULongLong());
         desc.reg = reg["name"].toVariant().toString();
         desc.refDesc = Core()->formatRefDesc(reg["ref"].toObject());
+        return desc;
+    };
 
-        registerRefs.push_back(desc);
+    // Only the values change from one stop to the next, update those rows
+    bool sameRows = regRefs.size() == shownRefs.size();
+    for (int i = 0; sameRows && i < regRefs.size(); i++) {
+        sameRows = regRefs.at(i).value("name") == shownRefs.at(i).value("name");
     }
-
-    registerRefModel->endResetModel();
+    if (sameRows) {
+        for (int i = 0; i < regRefs.size(); i++) {
+            if (regRefs[i] != shownRefs[i]) {
+                registerRefs[i] = describe(regRefs[i]);
+                emit registerRefModel->dataChanged(
+                    registerRefModel->index(i, 0),
+                    registerRefModel->index(i, RegisterRefModel::ColumnCount - 1));
+            }
+        }
+    } else {
+        registerRefModel->beginResetModel();
+        registerRefs.clear();
+        for (const QJsonObject &reg : regRefs) {
+            registerRefs.push_back(describe(reg));
+        }
+        registerRefModel->endResetModel();
+    }
+    shownRefs = regRefs;
 
     ui->registerRefTreeView->resizeColumnToContents(0);
     ui->registerRefTreeView->resizeColumnToContents(1);
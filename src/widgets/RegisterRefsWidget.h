@@ -84,6 +84,10 @@ private:
     RegisterRefModel *registerRefModel;
     RegisterRefProxyModel *registerRefProxyModel;
     QList<RegisterRefDescription> registerRefs;
+    // telescoped registers the rows were made from
+    QList<QJsonObject> shownRefs;
+    // DebugSnapshot generation of the registers shown
+    quint64 shownGeneration = 0;
     IaitoTreeWidget *tree;
     void setScrollMode();
 
@@ -1,4 +1,5 @@
 #include "RegistersWidget.h"
+#include "common/DebugSnapshot.h"
 #include "common/JsonModel.h"
 #include "ui_RegistersWidget.h"
 
@@ -40,6 +41,12 @@ void RegistersWidget::updateContents()
     if (!refreshDeferrer->attemptRefresh(nullptr)) {
         return;
     }
+    quint64 changed;
+    Core()->getDebugSnapshot()->getRegisterValues(&changed);
+    if (changed == shownRegisters) {
+        return;
+    }
+    shownRegisters = changed;
     setRegisterGrid();
 }
 
@@ -49,7 +56,7 @@ void RegistersWidget::setRegisterGrid()
     int col = 0;
     QLabel *registerLabel;
     QLineEdit *registerEditValue;
-    const auto registerRefs = Core()->getRegisterRefValues();
+    const auto registerRefs = Core()->getDebugSnapshot()->getRegisterValues();
 
     registerLen = registerRefs.size();
     for (auto &reg : registerRefs) {
@@ -35,5 +35,7 @@ private:
     AddressableItemContextMenu addressContextMenu;
     int numCols = 2;
     int registerLen = 0;
+    // DebugSnapshot generation of the registers shown
+    quint64 shownRegisters = 0;
     RefreshDeferrer *refreshDeferrer;
 };
@@ -1,4 +1,5 @@
 #include "RelocsWidget.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_ListDockWidget.h"
@@ -50,10 +51,10 @@ QVariant RelocsModel::data(const QModelIndex &index, int role) const
         if (index.column() < RelocsModel::ColumnCount) {
             // Blue color for unsafe functions
             if (thread_banned.match(reloc.name).hasMatch())
-                return Config()->getColor("gui.item_thread_unsafe");
+                return ConfigColor("gui.item_thread_unsafe");
             // Red color for unsafe functions
             if (unsafe_banned.match(reloc.name).hasMatch())
-                return Config()->getColor("gui.item_unsafe");
+                return ConfigColor("gui.item_unsafe");
         }
         break;
     case Qt::DisplayRole:
@@ -69,7 +70,7 @@ QVariant RelocsModel::data(const QModelIndex &index, int role) const
             return safety(model, reloc.name);
         }
         case RelocsModel::CommentColumn:
-            return Core()->getCommentAt(reloc.vaddr);
+            return Core()->getCommentCache()->at(reloc.vaddr);
         default:
             break;
         }
@@ -154,7 +155,8 @@ bool RelocsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &righ
         return a < b;
     }
     case RelocsModel::CommentColumn:
-        return Core()->getCommentAt(leftReloc.vaddr) < Core()->getCommentAt(rightReloc.vaddr);
+        return Core()->getCommentCache()->at(leftReloc.vaddr)
+               < Core()->getCommentCache()->at(rightReloc.vaddr);
     default:
         break;
     }
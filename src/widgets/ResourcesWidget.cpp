@@ -1,4 +1,5 @@
 #include "ResourcesWidget.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_ListDockWidget.h"
@@ -39,7 +40,7 @@ QVariant ResourcesModel::data(const QModelIndex &index, int role) const
         case LANG:
             return res.lang;
         case COMMENT:
-            return Core()->getCommentAt(res.vaddr);
+            return Core()->getCommentCache()->at(res.vaddr);
         default:
             return QVariant();
         }
@@ -1,4 +1,5 @@
 #include "SearchWidget.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_SearchWidget.h"
@@ -78,7 +79,7 @@ QVariant SearchModel::data(const QModelIndex &index, int role) const
         case DATA:
             return exp.data;
         case COMMENT:
-            return Core()->getCommentAt(exp.offset);
+            return Core()->getCommentCache()->at(exp.offset);
         default:
             return QVariant();
         }
@@ -180,7 +181,8 @@ bool SearchSortFilterProxyModel::lessThan(const QModelIndex &left, const QModelI
     case SearchModel::DATA:
         return left_search.data < right_search.data;
     case SearchModel::COMMENT:
-        return Core()->getCommentAt(left_search.offset) < Core()->getCommentAt(right_search.offset);
+        return Core()->getCommentCache()->at(left_search.offset)
+               < Core()->getCommentCache()->at(right_search.offset);
     default:
         break;
     }
@@ -212,15 +214,28 @@ SearchWidget::SearchWidget(MainWindow *main)
     });
 
     QShortcut *enter_press = new QShortcut(QKeySequence(Qt::Key_Return), this);
-    connect(enter_press, &QShortcut::activated, this, [this]() {
-        refreshSearch();
-        checkSearchResultEmpty();
-    });
+    connect(enter_press, &QShortcut::activated, this, [this]() { refreshSearch(true); });
     enter_press->setContext(Qt::WidgetWithChildrenShortcut);
 
-    connect(ui->searchButton, &QAbstractButton::clicked, this, [this]() {
-        refreshSearch();
-        checkSearchResultEmpty();
+    connect(ui->searchButton, &QAbstractButton::clicked, this, [this]() { refreshSearch(true); });
+    connect(ui->stopButton, &QAbstractButton::clicked, this, [this]() {
+        if (searchTask) {
+            searchTask->interrupt();
+        }
+    });
+
+    ui->maxHitsSpinBox->setValue(Config()->getSearchMaxHits());
+    connect(
+        ui->maxHitsSpinBox,
+        static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+        this,
+        [](int value) { Config()->setSearchMaxHits(value); });
+
+    searchTimer.setInterval(0);
+    connect(&searchTimer, &QTimer::timeout, this, [this]() {
+        if (searchTask->isInterrupted() || !searchTask->step()) {
+            searchFinished();
+        }
     });
 
     connect(
@@ -230,7 +245,10 @@ SearchWidget::SearchWidget(MainWindow *main)
         [this](int index) { updatePlaceholderText(index); });
 }
 
-SearchWidget::~SearchWidget() {}
+SearchWidget::~SearchWidget()
+{
+    stopSearch();
+}
 
 void SearchWidget::updateSearchBoundaries()
 {
@@ -300,21 +318,89 @@ void SearchWidget::refreshSearchspaces()
     refreshSearch();
 }
 
-void SearchWidget::refreshSearch()
+void SearchWidget::refreshSearch(bool reportEmpty)
 {
+    stopSearch();
+
     QString search_for = ui->filterLineEdit->text();
     QVariant searchspace_data = ui->searchspaceCombo->currentData();
     QString searchspace = searchspace_data.toString();
 
     search_model->beginResetModel();
-    search = Core()->getAllSearch(search_for, searchspace);
+    search.clear();
     search_model->endResetModel();
 
-    qhelpers::adjustColumns(ui->searchTreeView, 3, 0);
+    if (search_for.isEmpty()) {
+        return;
+    }
+
+    this->reportEmpty = reportEmpty;
+    int generation = searchGeneration;
+    searchTask.reset(new SearchTask(search_for, searchspace, ui->maxHitsSpinBox->value()));
+    connect(
+        searchTask.data(),
+        &SearchTask::hitsFound,
+        this,
+        [this, generation](const QList<SearchDescription> &hits) {
+            if (generation == searchGeneration) {
+                appendHits(hits);
+            }
+        });
+    ui->searchButton->setEnabled(false);
+    ui->stopButton->setEnabled(true);
+#if MONOTHREAD
+    searchTimer.start();
+#else
+    connect(searchTask.data(), &AsyncTask::finished, this, [this, generation]() {
+        if (generation == searchGeneration) {
+            searchFinished();
+        }
+    });
+    Core()->getAsyncTaskManager()->start(searchTask);
+#endif
+}
+
+void SearchWidget::appendHits(const QList<SearchDescription> &hits)
+{
+    bool first = search.isEmpty();
+    search_model->beginInsertRows(QModelIndex(), search.size(), search.size() + hits.size() - 1);
+    search += hits;
+    search_model->endInsertRows();
+
+    if (first) {
+        qhelpers::adjustColumns(ui->searchTreeView, 3, 0);
+    }
+}
+
+void SearchWidget::searchFinished()
+{
+    searchTimer.stop();
+    ui->searchButton->setEnabled(true);
+    ui->stopButton->setEnabled(false);
+
+    bool interrupted = searchTask->isInterrupted();
+    searchTask.clear();
+    if (reportEmpty && !interrupted) {
+        checkSearchResultEmpty();
+    }
+}
+
+void SearchWidget::stopSearch()
+{
+    searchTimer.stop();
+    if (searchTask) {
+        searchTask->interrupt();
+        searchTask.clear();
+    }
+    // Drop the hits of the task still waiting in the event queue
+    searchGeneration++;
+    ui->searchButton->setEnabled(true);
+    ui->stopButton->setEnabled(false);
 }
 
 // No Results Found information message when search returns empty
-// Called by &QShortcut::activated and &QAbstractButton::clicked signals
+// Called once a search started by &QShortcut::activated or
+// &QAbstractButton::clicked signals is done
 void SearchWidget::checkSearchResultEmpty()
 {
     if (search.isEmpty()) {
@@ -4,10 +4,13 @@
 #include <memory>
 
 #include <QAbstractItemModel>
+#include <QSharedPointer>
 #include <QSortFilterProxyModel>
+#include <QTimer>
 
 #include "AddressableItemList.h"
 #include "IaitoDockWidget.h"
+#include "common/SearchTask.h"
 #include "core/Iaito.h"
 
 class MainWindow;
@@ -76,7 +79,18 @@ private:
     SearchSortFilterProxyModel *search_proxy_model;
     QList<SearchDescription> search;
 
-    void refreshSearch();
+    QSharedPointer<SearchTask> searchTask;
+    // searches on the GUI thread when the core is single threaded
+    QTimer searchTimer;
+    // incremented on every search, so hits of a stopped search are ignored
+    int searchGeneration = 0;
+    // whether to tell the user when the running search found nothing
+    bool reportEmpty = false;
+
+    void refreshSearch(bool reportEmpty = false);
+    void appendHits(const QList<SearchDescription> &hits);
+    void searchFinished();
+    void stopSearch();
     void checkSearchResultEmpty();
     void setScrollMode();
     void updatePlaceholderText(int index);
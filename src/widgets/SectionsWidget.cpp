@@ -1,5 +1,6 @@
 #include "SectionsWidget.h"
 #include "QuickFilterView.h"
+#include "common/CommentCache.h"
 #include "common/Configuration.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
@@ -70,7 +71,7 @@ QVariant SectionsModel::data(const QModelIndex &index, int role) const
         case SectionsModel::EntropyColumn:
             return section.entropy;
         case SectionsModel::CommentColumn:
-            return Core()->getCommentAt(section.vaddr);
+            return Core()->getCommentCache()->at(section.vaddr);
         default:
             return QVariant();
         }
@@ -158,7 +159,8 @@ bool SectionsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &ri
     case SectionsModel::EntropyColumn:
         return leftSection.entropy < rightSection.entropy;
     case SectionsModel::CommentColumn:
-        return Core()->getCommentAt(leftSection.vaddr) < Core()->getCommentAt(rightSection.vaddr);
+        return Core()->getCommentCache()->at(leftSection.vaddr)
+               < Core()->getCommentCache()->at(rightSection.vaddr);
     }
 }
 
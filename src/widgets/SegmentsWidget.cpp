@@ -1,4 +1,5 @@
 #include "SegmentsWidget.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_ListDockWidget.h"
@@ -58,7 +59,7 @@ QVariant SegmentsModel::data(const QModelIndex &index, int role) const
         case SegmentsModel::PermColumn:
             return segment.perm;
         case SegmentsModel::CommentColumn:
-            return Core()->getCommentAt(segment.vaddr);
+            return Core()->getCommentCache()->at(segment.vaddr);
         default:
             return QVariant();
         }
@@ -131,7 +132,8 @@ bool SegmentsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &ri
     case SegmentsModel::EndAddressColumn:
         return leftSegment.vaddr < rightSegment.vaddr;
     case SegmentsModel::CommentColumn:
-        return Core()->getCommentAt(leftSegment.vaddr) < Core()->getCommentAt(rightSegment.vaddr);
+        return Core()->getCommentCache()->at(leftSegment.vaddr)
+               < Core()->getCommentCache()->at(rightSegment.vaddr);
     default:
         break;
     }
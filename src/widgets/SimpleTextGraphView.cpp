@@ -72,9 +72,11 @@ void SimpleTextGraphView::selectBlockWithId(ut64 blockId)
     if (!enableBlockSelection) {
         return;
     }
+    setBlockDirty(selectedBlock);
     auto contentIt = blockContent.find(blockId);
     if (contentIt != blockContent.end()) {
         selectedBlock = blockId;
+        setBlockDirty(selectedBlock);
         if (haveAddresses) {
             addressableItemContextMenu.setTarget(contentIt->second.address, contentIt->second.text);
         }
@@ -143,6 +145,7 @@ void SimpleTextGraphView::setBlockSelectionEnabled(bool value)
 {
     enableBlockSelection = value;
     if (!value) {
+        setBlockDirty(selectedBlock);
         selectedBlock = NO_BLOCK_SELECTED;
     }
 }
@@ -247,10 +250,3 @@ void SimpleTextGraphView::restoreCurrentBlock()
         }
     }
 }
-
-void SimpleTextGraphView::paintEvent(QPaintEvent *event)
-{
-    // SimpleTextGraphView is always dirty
-    setCacheDirty();
-    GraphView::paintEvent(event);
-}
@@ -41,7 +41,6 @@ public slots:
     void selectBlockWithId(ut64 blockId);
 
 protected:
-    void paintEvent(QPaintEvent *event) override;
     void contextMenuEvent(QContextMenuEvent *event) override;
     void blockContextMenuRequested(
         GraphView::GraphBlock &block, QContextMenuEvent *event, QPoint pos) override;
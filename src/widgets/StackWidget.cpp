@@ -1,4 +1,6 @@
 #include "StackWidget.h"
+#include "common/CommentCache.h"
+#include "common/DebugSnapshot.h"
 #include "common/Helpers.h"
 #include "common/JsonModel.h"
 #include "dialogs/EditInstructionDialog.h"
@@ -149,21 +151,45 @@ StackModel::StackModel(QObject *parent)
     : QAbstractTableModel(parent)
 {}
 
+StackModel::Item StackModel::makeItem(const QJsonObject &stackItem)
+{
+    Item item;
+    item.offset = stackItem["addr"].toVariant().toULongLong();
+    item.value = RAddressString(stackItem["value"].toVariant().toULongLong());
+    item.refDesc = Core()->formatRefDesc(stackItem["ref"].toObject());
+    return item;
+}
+
 void StackModel::reload()
 {
-    QList<QJsonObject> stackItems = Core()->getStack();
+    quint64 changed;
+    QList<QJsonObject> stackItems = Core()->getDebugSnapshot()->getStack(&changed);
+    if (changed == shownStack) {
+        return;
+    }
+    shownStack = changed;
+
+    bool sameRows = stackItems.size() == shownItems.size();
+    for (int i = 0; sameRows && i < stackItems.size(); i++) {
+        sameRows = stackItems.at(i).value("addr") == shownItems.at(i).value("addr");
+    }
+    if (sameRows) {
+        for (int i = 0; i < stackItems.size(); i++) {
+            if (stackItems[i] != shownItems[i]) {
+                values[i] = makeItem(stackItems[i]);
+                emit dataChanged(index(i, 0), index(i, ColumnCount - 1));
+            }
+        }
+        shownItems = stackItems;
+        return;
+    }
 
     beginResetModel();
     values.clear();
     for (const QJsonObject &stackItem : stackItems) {
-        Item item;
-
-        item.offset = stackItem["addr"].toVariant().toULongLong();
-        item.value = RAddressString(stackItem["value"].toVariant().toULongLong());
-        item.refDesc = Core()->formatRefDesc(stackItem["ref"].toObject());
-
-        values.push_back(item);
+        values.push_back(makeItem(stackItem));
     }
+    shownItems = stackItems;
     endResetModel();
 }
 
@@ -194,7 +220,7 @@ QVariant StackModel::data(const QModelIndex &index, int role) const
         case DescriptionColumn:
             return item.refDesc.ref;
         case CommentColumn:
-            return Core()->getCommentAt(item.offset);
+            return Core()->getCommentCache()->at(item.offset);
         default:
             return QVariant();
         }
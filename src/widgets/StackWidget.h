@@ -31,6 +31,10 @@ public:
 
     StackModel(QObject *parent = nullptr);
 
+    /**
+     * @brief Update the rows that changed since the last stop, the model is
+     * only reset if the stack pointer moved
+     */
     void reload();
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -45,6 +49,12 @@ public:
 
 private:
     QVector<Item> values;
+    // telescoped items the rows were made from
+    QList<QJsonObject> shownItems;
+    // DebugSnapshot generation of the stack shown
+    quint64 shownStack = 0;
+
+    static Item makeItem(const QJsonObject &stackItem);
 };
 Q_DECLARE_METATYPE(StackModel::Item)
 
@@ -1,7 +1,9 @@
 #include "StringsWidget.h"
 #include "WidgetShortcuts.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
+#include "dialogs/AsyncTaskDialog.h"
 #include "ui_StringsWidget.h"
 
 #include <QClipboard>
@@ -47,7 +49,7 @@ QVariant StringsModel::data(const QModelIndex &index, int role) const
         case StringsModel::SectionColumn:
             return str.section;
         case StringsModel::CommentColumn:
-            return Core()->getCommentAt(str.vaddr);
+            return Core()->getCommentCache()->at(str.vaddr);
         default:
             return QVariant();
         }
@@ -134,7 +136,8 @@ bool StringsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &rig
     case StringsModel::SectionColumn:
         return leftStr->section < rightStr->section;
     case StringsModel::CommentColumn:
-        return Core()->getCommentAt(leftStr->vaddr) < Core()->getCommentAt(rightStr->vaddr);
+        return Core()->getCommentCache()->at(leftStr->vaddr)
+               < Core()->getCommentCache()->at(rightStr->vaddr);
     default:
         break;
     }
@@ -220,30 +223,94 @@ StringsWidget::StringsWidget(MainWindow *main)
     header->setSectionResizeMode(StringsModel::StringColumn, QHeaderView::ResizeMode::Stretch);
     header->setStretchLastSection(false);
     header->setResizeContentsPrecision(256);
+
+    scanTimer.setInterval(0);
+    connect(&scanTimer, &QTimer::timeout, this, [this]() {
+        if (task->isInterrupted() || !task->step()) {
+            scanFinished();
+        }
+    });
 }
 
-StringsWidget::~StringsWidget() {}
+StringsWidget::~StringsWidget()
+{
+    cancelScan();
+}
 
 void StringsWidget::refreshStrings()
 {
-#if MONOTHREAD
-    auto strings = Core()->getAllStrings();
-    this->strings = strings;
+    cancelScan();
+    model->beginResetModel();
+    strings.clear();
     model->endResetModel();
     tree->showItemsNumber(proxyModel->rowCount());
-#else
-    if (task) {
-        task->wait();
-    }
-    task = QSharedPointer<StringsTask>(new StringsTask());
+
+    int generation = scanGeneration;
+    task.reset(new StringsTask());
     connect(
-        task.data(), &StringsTask::stringSearchFinished, this, &StringsWidget::stringSearchFinished);
+        task.data(),
+        &StringsTask::stringsFound,
+        this,
+        [this, generation](const QList<StringDescription> &found) {
+            if (generation == scanGeneration) {
+                appendStrings(found);
+            }
+        });
+#if MONOTHREAD
+    scanTimer.start();
+#else
+    connect(task.data(), &AsyncTask::finished, this, [this, generation]() {
+        if (generation == scanGeneration) {
+            scanFinished();
+        }
+    });
     Core()->getAsyncTaskManager()->start(task);
 #endif
 
+    QTimer::singleShot(SCAN_DIALOG_DELAY_MS, this, [this, generation]() {
+        if (generation != scanGeneration || !task || scanDialog || !isVisible()) {
+            return;
+        }
+        scanDialog = new AsyncTaskDialog(task, this);
+        scanDialog->setAttribute(Qt::WA_DeleteOnClose);
+        scanDialog->show();
+    });
+
     refreshSectionCombo();
 }
 
+void StringsWidget::appendStrings(const QList<StringDescription> &found)
+{
+    model->beginInsertRows(QModelIndex(), strings.size(), strings.size() + found.size() - 1);
+    strings += found;
+    model->endInsertRows();
+
+    tree->showItemsNumber(proxyModel->rowCount());
+}
+
+void StringsWidget::scanFinished()
+{
+    scanTimer.stop();
+    if (scanDialog) {
+        scanDialog->close();
+    }
+    task.clear();
+}
+
+void StringsWidget::cancelScan()
+{
+    scanTimer.stop();
+    if (scanDialog) {
+        scanDialog->close();
+    }
+    if (task) {
+        task->interrupt();
+        task.clear();
+    }
+    // Drop the results of the task still waiting in the event queue
+    scanGeneration++;
+}
+
 void StringsWidget::refreshSectionCombo()
 {
     QComboBox *combo = ui->quickFilterView->comboBox();
@@ -258,17 +325,6 @@ void StringsWidget::refreshSectionCombo()
     proxyModel->selectedSection.clear();
 }
 
-void StringsWidget::stringSearchFinished(const QList<StringDescription> &strings)
-{
-    model->beginResetModel();
-    this->strings = strings;
-    model->endResetModel();
-
-    tree->showItemsNumber(proxyModel->rowCount());
-
-    task.clear();
-}
-
 void StringsWidget::on_actionCopy()
 {
     QModelIndex current_item = ui->stringsTreeView->currentIndex();
@@ -10,8 +10,11 @@
 #include "core/Iaito.h"
 
 #include <QAbstractListModel>
+#include <QPointer>
 #include <QSortFilterProxyModel>
+#include <QTimer>
 
+class AsyncTaskDialog;
 class MainWindow;
 class QTreeWidgetItem;
 class StringsWidget;
@@ -81,20 +84,31 @@ public:
 
 private slots:
     void refreshStrings();
-    void stringSearchFinished(const QList<StringDescription> &strings);
     void refreshSectionCombo();
 
     void on_actionCopy();
 
 private:
+    // Only show the task dialog if the scan takes a while
+    static constexpr int SCAN_DIALOG_DELAY_MS = 1000;
+
     std::unique_ptr<Ui::StringsWidget> ui;
 
     QSharedPointer<StringsTask> task;
+    // scans the task on the GUI thread when the core is single threaded
+    QTimer scanTimer;
+    QPointer<AsyncTaskDialog> scanDialog;
+    // incremented on every refresh, so results of a dropped scan are ignored
+    int scanGeneration = 0;
 
     StringsModel *model;
     StringsProxyModel *proxyModel;
     QList<StringDescription> strings;
     IaitoTreeWidget *tree;
+
+    void appendStrings(const QList<StringDescription> &found);
+    void scanFinished();
+    void cancelScan();
 };
 
 #endif // STRINGSWIDGET_H
@@ -1,4 +1,5 @@
 #include "SymbolsWidget.h"
+#include "common/CommentCache.h"
 #include "common/Helpers.h"
 #include "core/MainWindow.h"
 #include "ui_ListDockWidget.h"
@@ -38,7 +39,7 @@ QVariant SymbolsModel::data(const QModelIndex &index, int role) const
         case SymbolsModel::NameColumn:
             return symbol.name;
         case SymbolsModel::CommentColumn:
-            return Core()->getCommentAt(symbol.vaddr);
+            return Core()->getCommentCache()->at(symbol.vaddr);
         default:
             return QVariant();
         }
@@ -109,7 +110,8 @@ bool SymbolsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &rig
     case SymbolsModel::NameColumn:
         return leftSymbol.name < rightSymbol.name;
     case SymbolsModel::CommentColumn:
-        return Core()->getCommentAt(leftSymbol.vaddr) < Core()->getCommentAt(rightSymbol.vaddr);
+        return Core()->getCommentCache()->at(leftSymbol.vaddr)
+               < Core()->getCommentCache()->at(rightSymbol.vaddr);
     default:
         break;
     }
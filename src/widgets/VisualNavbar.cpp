@@ -11,6 +11,8 @@
 #include <QJsonObject>
 #include <QJsonParseError>
 #include <QMouseEvent>
+#include <QPainter>
+#include <QPixmap>
 #include <QToolTip>
 
 #include <array>
@@ -124,7 +126,7 @@ void VisualNavbar::updateGraphicsScene()
     xToAddress.clear();
     seekGraphicsItem = nullptr;
     PCGraphicsItem = nullptr;
-    graphicsScene->setBackgroundBrush(QBrush(Config()->getColor("gui.navbar.empty")));
+    graphicsScene->setBackgroundBrush(QBrush(ConfigColor("gui.navbar.empty")));
 
     if (stats.to <= stats.from) {
         return;
@@ -141,17 +143,28 @@ void VisualNavbar::updateGraphicsScene()
         return (addr - beginAddr) * widthPerByte;
     };
 
-    std::array<QBrush, static_cast<int>(DataType::Count)> dataTypeBrushes;
-    dataTypeBrushes[static_cast<int>(DataType::Code)] = QBrush(
-        Config()->getColor("gui.navbar.code"));
-    dataTypeBrushes[static_cast<int>(DataType::String)] = QBrush(
-        Config()->getColor("gui.navbar.str"));
-    dataTypeBrushes[static_cast<int>(DataType::Symbol)] = QBrush(
-        Config()->getColor("gui.navbar.sym"));
+    std::array<QColor, static_cast<int>(DataType::Count)> dataTypeColors;
+    dataTypeColors[static_cast<int>(DataType::Code)] = ConfigColor("gui.navbar.code");
+    dataTypeColors[static_cast<int>(DataType::String)] = ConfigColor("gui.navbar.str");
+    dataTypeColors[static_cast<int>(DataType::Symbol)] = ConfigColor("gui.navbar.sym");
+
+    // Paint the whole strip in a single pixmap, only the cursors are separate
+    // items so moving them doesn't paint the strip again
+    qreal dpr = devicePixelRatioF();
+    QPixmap strip(qMax(1, qRound(w * dpr)), qMax(1, qRound(h * dpr)));
+    strip.setDevicePixelRatio(dpr);
+    strip.fill(Qt::transparent);
+    QPainter painter(&strip);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
 
     DataType lastDataType = DataType::Empty;
-    QGraphicsRectItem *dataItem = nullptr;
     QRectF dataItemRect(0.0, 0.0, 0.0, h);
+    auto paintDataItem = [&]() {
+        if (lastDataType != DataType::Empty) {
+            painter.fillRect(dataItemRect, dataTypeColors[static_cast<int>(lastDataType)]);
+        }
+    };
     for (const BlockDescription &block : stats.blocks) {
         // Keep track of where which memory segment is mapped so we are able to
         // convert from address to X coordinate and vice versa.
@@ -172,30 +185,22 @@ void VisualNavbar::updateGraphicsScene()
         } else if (block.inFunctions > 0) {
             dataType = DataType::Code;
         } else {
-            lastDataType = DataType::Empty;
-            continue;
+            dataType = DataType::Empty;
         }
 
         if (dataType == lastDataType) {
-            double r = xFromAddr(block.addr + block.size);
-            if (r > dataItemRect.right()) {
-                dataItemRect.setRight(r);
-                dataItem->setRect(dataItemRect);
-            }
-            dataItem->setRect(dataItemRect);
+            dataItemRect.setRight(qMax(dataItemRect.right(), x2a.x_end));
             continue;
         }
 
-        dataItemRect.setX(xFromAddr(block.addr));
-        dataItemRect.setRight(xFromAddr(block.addr + block.size));
-
-        dataItem = new QGraphicsRectItem();
-        dataItem->setPen(Qt::NoPen);
-        dataItem->setBrush(dataTypeBrushes[static_cast<int>(dataType)]);
-        graphicsScene->addItem(dataItem);
-
+        paintDataItem();
+        dataItemRect.setX(x2a.x_start);
+        dataItemRect.setRight(x2a.x_end);
         lastDataType = dataType;
     }
+    paintDataItem();
+    painter.end();
+    graphicsScene->addPixmap(strip);
 
     // Update scene width
     graphicsScene->setSceneRect(0, 0, w, h);
@@ -223,12 +228,12 @@ void VisualNavbar::drawCursor(RVA addr, QColor color, QGraphicsRectItem *&graphi
 
 void VisualNavbar::drawPCCursor()
 {
-    drawCursor(Core()->getProgramCounterValue(), Config()->getColor("gui.navbar.pc"), PCGraphicsItem);
+    drawCursor(Core()->getProgramCounterValue(), ConfigColor("gui.navbar.pc"), PCGraphicsItem);
 }
 
 void VisualNavbar::drawSeekCursor()
 {
-    drawCursor(Core()->getOffset(), Config()->getColor("gui.navbar.seek"), seekGraphicsItem);
+    drawCursor(Core()->getOffset(), ConfigColor("gui.navbar.seek"), seekGraphicsItem);
 }
 
 void VisualNavbar::on_seekChanged(RVA addr)